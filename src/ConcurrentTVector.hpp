@@ -0,0 +1,474 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// An append-only vector that many threads can append to without locks
+// The elements live in segments that are never moved, so an iterator can be dereferenced by any thread as soon as it's returned
+// Nothing is ever shifted or erased, so the atom and the mark of an element both collapse into its slot index and its published state
+template <class Type>
+class ConcurrentTVector
+{
+public:
+
+	struct Iterator;
+
+	// Type aliases
+	using Data = std::aligned_storage_t<sizeof(Type), alignof(Type)>;
+	using Reference = Type&;
+	using CReference = const Type&;
+	using Pointer = Type*;
+	using Position = std::size_t;
+	using Size = std::size_t;
+
+	// State of a slot, written with release semantics by the producer that reserved it
+	static constexpr std::uint8_t Pending = 0u;
+	static constexpr std::uint8_t Published = 1u;
+	static constexpr std::uint8_t Abandoned = 2u;
+
+	// An element of the vector, valid from the moment it's returned
+	struct Iterator
+	{
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Pointer;
+		using reference = Reference;
+
+		Iterator() :
+			mIndex(0u),
+			mParentVector(nullptr)
+		{
+		}
+
+		Iterator(const Position& Index, ConcurrentTVector* ParentVector) :
+			mIndex(Index),
+			mParentVector(ParentVector)
+		{
+		}
+
+		Reference operator*() const
+		{
+			return (*mParentVector)[mIndex];
+		}
+		Pointer operator->() const
+		{
+			return &(*mParentVector)[mIndex];
+		}
+
+		Iterator& operator++()
+		{
+			++mIndex;
+			return *this;
+		}
+		Iterator operator++(int)
+		{
+			auto Previous = *this;
+			++mIndex;
+			return Previous;
+		}
+		Iterator& operator--()
+		{
+			--mIndex;
+			return *this;
+		}
+		Iterator operator--(int)
+		{
+			auto Previous = *this;
+			--mIndex;
+			return Previous;
+		}
+
+		Iterator operator+(const difference_type& Offset) const
+		{
+			return Iterator(mIndex + Offset, mParentVector);
+		}
+		Iterator operator-(const difference_type& Offset) const
+		{
+			return Iterator(mIndex - Offset, mParentVector);
+		}
+		difference_type operator-(const Iterator& Right) const
+		{
+			return static_cast<difference_type>(mIndex) - static_cast<difference_type>(Right.mIndex);
+		}
+
+		bool operator==(const Iterator& Right) const
+		{
+			return mIndex == Right.mIndex;
+		}
+		bool operator!=(const Iterator& Right) const
+		{
+			return mIndex != Right.mIndex;
+		}
+		bool operator<(const Iterator& Right) const
+		{
+			return mIndex < Right.mIndex;
+		}
+
+		// Check if the iterator points to a published element
+		bool isValid() const
+		{
+			return mParentVector && mParentVector->isPublished(mIndex);
+		}
+
+		// The slot of the element
+		const Position& index() const noexcept
+		{
+			return mIndex;
+		}
+
+	private:
+		Position			mIndex;
+		ConcurrentTVector*	mParentVector;
+	};
+
+	// Appends on behalf of a single thread, reserving BlockSize slots at once so the threads rarely touch the shared counter
+	// The slots it reserved and didn't fill are abandoned when it's destroyed
+	class Producer
+	{
+	public:
+
+		Producer(Producer&& Move) noexcept :
+			mParentVector(Move.mParentVector),
+			mBlockSize(Move.mBlockSize),
+			mNext(Move.mNext),
+			mEnd(Move.mEnd)
+		{
+			Move.mNext = Move.mEnd = 0u;
+		}
+
+		Producer(const Producer& Copy) = delete;
+		Producer& operator=(const Producer& Copy) = delete;
+
+		// Abandon the rest of the block, its segments already exist so nothing is allocated here
+		~Producer()
+		{
+			for (; mNext < mEnd; ++mNext)
+				mParentVector->state(mNext).store(Abandoned, std::memory_order_release);
+		}
+
+		// Construct an element in the next reserved slot
+		template <class... TArgs>
+		Iterator emplaceBack(TArgs&&... Args)
+		{
+			if (mNext == mEnd)
+			{
+				mNext = mParentVector->mReserved.fetch_add(mBlockSize, std::memory_order_relaxed);
+				mEnd = mNext + mBlockSize;
+
+				// Allocate the segments of the whole block now, the destructor may have to abandon any of its slots
+				mParentVector->allocateSegments(mNext, mEnd);
+			}
+
+			auto Index = mNext++;
+			mParentVector->construct(Index, std::forward<TArgs>(Args)...);
+
+			return Iterator(Index, mParentVector);
+		}
+
+	private:
+		friend class ConcurrentTVector;
+
+		Producer(ConcurrentTVector& ParentVector, const Size& BlockSize) :
+			mParentVector(&ParentVector),
+			mBlockSize(BlockSize),
+			mNext(0u),
+			mEnd(0u)
+		{
+			assert(BlockSize > 0);
+		}
+
+	private:
+		ConcurrentTVector*	mParentVector;
+		Size				mBlockSize;
+		Position			mNext;
+		Position			mEnd;
+	};
+
+	// Default constructor
+	ConcurrentTVector() :
+		mReserved(0u),
+		mPublished(0u)
+	{
+		for (auto& Segment : mSegments)
+			Segment.store(nullptr, std::memory_order_relaxed);
+	}
+
+	ConcurrentTVector(const ConcurrentTVector& Copy) = delete;
+	ConcurrentTVector& operator=(const ConcurrentTVector& Copy) = delete;
+
+	// Destroys the published elements, no thread may be appending
+	~ConcurrentTVector()
+	{
+		auto Reserved = mReserved.load(std::memory_order_acquire);
+		for (auto SegmentIndex = Size(0); SegmentIndex < MaxSegments; ++SegmentIndex)
+		{
+			auto Segment = mSegments[SegmentIndex].load(std::memory_order_acquire);
+			if (!Segment)
+				continue;
+
+			auto First = segmentFirst(SegmentIndex);
+			for (auto Offset = Size(0); Offset < segmentSize(SegmentIndex) && First + Offset < Reserved; ++Offset)
+				if (Segment->mStates[Offset].load(std::memory_order_acquire) == Published)
+					reinterpret_cast<Pointer>(Segment->mData.get() + Offset)->~Type();
+
+			delete Segment;
+		}
+	}
+
+#pragma region Element access
+
+	// Access a published element
+	Reference operator[](const Position& Index)
+	{
+		assert(isPublished(Index) && "The element is not published yet");
+
+		return *reinterpret_cast<Pointer>(slotData(Index));
+	}
+	CReference operator[](const Position& Index) const
+	{
+		assert(isPublished(Index) && "The element is not published yet");
+
+		return *reinterpret_cast<const Type*>(slotData(Index));
+	}
+
+	// Checks whether the element in a slot has been constructed and can be read by this thread
+	bool isPublished(const Position& Index) const
+	{
+		return slotState(Index) == Published;
+	}
+
+	// Calls Function(Element) for every published element below publishedSize(), in order
+	template <class TFunction>
+	void forEach(TFunction&& Function)
+	{
+		auto Count = publishedSize();
+		for (auto Index = Position(0); Index < Count; ++Index)
+			if (isPublished(Index))
+				Function(*reinterpret_cast<Pointer>(slotData(Index)));
+	}
+
+#pragma endregion
+
+#pragma region Iterators
+
+	// The range of the slots below publishedSize(), abandoned slots in it are not valid
+	Iterator begin()
+	{
+		return Iterator(0u, this);
+	}
+	Iterator end()
+	{
+		return Iterator(publishedSize(), this);
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Returns the number of reserved slots, some of them may still be under construction
+	Size size() const noexcept
+	{
+		return mReserved.load(std::memory_order_acquire);
+	}
+
+	// Returns the number of slots from the start that are all published or abandoned
+	Size publishedSize() const
+	{
+		auto Published = mPublished.load(std::memory_order_acquire);
+		auto Reserved = mReserved.load(std::memory_order_acquire);
+		while (Published < Reserved && slotState(Published) != Pending)
+			++Published;
+
+		// Let the next readers start from here, unless another reader went further already
+		auto Current = mPublished.load(std::memory_order_relaxed);
+		while (Current < Published && !mPublished.compare_exchange_weak(Current, Published, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+
+		return Published;
+	}
+
+	// Allocates the segments for a number of elements, so the appends below it never allocate
+	// An allocation failure during an append leaves its slot pending forever, reserving avoids it
+	void reserve(const Size& NewCapacity)
+	{
+		for (auto SegmentIndex = Size(0); SegmentIndex < MaxSegments && segmentFirst(SegmentIndex) < NewCapacity; ++SegmentIndex)
+			getSegment(SegmentIndex);
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Construct an element at the end, any number of threads can call it at the same time
+	template <class... TArgs>
+	Iterator emplaceBack(TArgs&&... Args)
+	{
+		auto Index = mReserved.fetch_add(1u, std::memory_order_relaxed);
+		construct(Index, std::forward<TArgs>(Args)...);
+
+		return Iterator(Index, this);
+	}
+	Iterator pushBack(const Type& Value)
+	{
+		return emplaceBack(Value);
+	}
+	Iterator pushBack(Type&& Value)
+	{
+		return emplaceBack(std::move(Value));
+	}
+
+	// Returns an appender for the calling thread, see Producer
+	Producer producer(const Size& BlockSize = 64u)
+	{
+		return Producer(*this, BlockSize);
+	}
+
+#pragma endregion
+
+private:
+
+	// The first segment holds 2^FirstSegmentBits elements, every next one twice as many as the previous
+	static constexpr Size FirstSegmentBits = 10u;
+	static constexpr Size MaxSegments = sizeof(Size) * 8u - FirstSegmentBits;
+
+	struct Segment
+	{
+		std::unique_ptr<Data[]>							mData;
+		std::unique_ptr<std::atomic<std::uint8_t>[]>	mStates;
+	};
+
+	static Size segmentSize(const Size& SegmentIndex)
+	{
+		return Size(1) << (SegmentIndex + FirstSegmentBits);
+	}
+
+	// Index of the first element of a segment
+	static Size segmentFirst(const Size& SegmentIndex)
+	{
+		return segmentSize(SegmentIndex) - (Size(1) << FirstSegmentBits);
+	}
+
+	// Segment of an element, from the highest bit of Index + 2^FirstSegmentBits
+	static Size segmentOf(const Position& Index)
+	{
+		auto Value = static_cast<std::uint64_t>(Index + (Size(1) << FirstSegmentBits));
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long Bit;
+		_BitScanReverse64(&Bit, Value);
+		return static_cast<Size>(Bit) - FirstSegmentBits;
+#elif defined(__GNUC__)
+		return static_cast<Size>(63 - __builtin_clzll(Value)) - FirstSegmentBits;
+#else
+		auto Bit = Size(0);
+		while (Value >>= 1)
+			++Bit;
+		return Bit - FirstSegmentBits;
+#endif
+	}
+
+	// Returns a segment, allocating it if no thread did yet
+	Segment& getSegment(const Size& SegmentIndex)
+	{
+		auto Current = mSegments[SegmentIndex].load(std::memory_order_acquire);
+		if (Current)
+			return *Current;
+
+		// The states start as Pending
+		std::unique_ptr<Segment> NewSegment(new Segment{ std::unique_ptr<Data[]>(new Data[segmentSize(SegmentIndex)]), std::unique_ptr<std::atomic<std::uint8_t>[]>(new std::atomic<std::uint8_t>[segmentSize(SegmentIndex)]()) });
+
+		// Only one thread installs its segment, the others use it
+		if (mSegments[SegmentIndex].compare_exchange_strong(Current, NewSegment.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+			return *NewSegment.release();
+
+		return *Current;
+	}
+
+	// State of a slot, Pending if its segment doesn't exist yet
+	std::uint8_t slotState(const Position& Index) const
+	{
+		auto SegmentIndex = segmentOf(Index);
+		auto Current = mSegments[SegmentIndex].load(std::memory_order_acquire);
+
+		return Current ? Current->mStates[Index - segmentFirst(SegmentIndex)].load(std::memory_order_acquire) : Pending;
+	}
+
+	// Allocates the segments holding [First, Last)
+	void allocateSegments(const Position& First, const Position& Last)
+	{
+		for (auto SegmentIndex = segmentOf(First); SegmentIndex < MaxSegments && SegmentIndex <= segmentOf(Last - 1); ++SegmentIndex)
+			getSegment(SegmentIndex);
+	}
+
+	// State of a reserved slot, whose segment was allocated along with its block
+	std::atomic<std::uint8_t>& state(const Position& Index)
+	{
+		auto SegmentIndex = segmentOf(Index);
+		auto Current = mSegments[SegmentIndex].load(std::memory_order_acquire);
+		assert(Current);
+
+		return Current->mStates[Index - segmentFirst(SegmentIndex)];
+	}
+
+	Data* slotData(const Position& Index) const
+	{
+		auto SegmentIndex = segmentOf(Index);
+		return mSegments[SegmentIndex].load(std::memory_order_acquire)->mData.get() + (Index - segmentFirst(SegmentIndex));
+	}
+
+	// Construct the element of a reserved slot and publish it, a throwing constructor abandons the slot
+	template <class... TArgs>
+	void construct(const Position& Index, TArgs&&... Args)
+	{
+		auto SegmentIndex = segmentOf(Index);
+		assert(SegmentIndex < MaxSegments);
+
+		auto& Slots = getSegment(SegmentIndex);
+		auto Offset = Index - segmentFirst(SegmentIndex);
+		try
+		{
+			new(Slots.mData.get() + Offset) Type(std::forward<TArgs>(Args)...);
+		}
+		catch (...)
+		{
+			Slots.mStates[Offset].store(Abandoned, std::memory_order_release);
+			throw;
+		}
+
+		// Readers that see the state see the element
+		Slots.mStates[Offset].store(Published, std::memory_order_release);
+	}
+
+private:
+	std::atomic<Segment*>	mSegments[MaxSegments];
+
+	// Slots handed to the producers, and a lower bound of publishedSize() shared by the readers
+	alignas(64) std::atomic<Size>	mReserved;
+	alignas(64) mutable std::atomic<Size>	mPublished;
+};
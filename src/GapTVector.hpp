@@ -0,0 +1,698 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+// A TVector whose storage keeps a movable gap, the array is circular so a gap at the front is the same as a gap at the back
+// Insertions and erasures move the gap to their position first, the cost is the distance from the last edit instead of the
+// distance from the end, so pushes and pops at both ends and repeated edits around a cursor are amortized O(1)
+// The elements are not contiguous, there is no data()
+template <class Type, class ID = std::uint32_t>
+class GapTVector
+{
+	// Elements are moved across the gap in place, a move can't be undone half way
+	static_assert(TRelocator<Type>::IsNoexcept, "GapTVector elements must be relocatable without throwing");
+
+	struct Mark;
+
+public:
+
+	template <bool TConstness>
+	struct TIterator;
+
+	// Type aliases
+	using Data = std::aligned_storage_t<sizeof(Type), alignof(Type)>;
+	using Reference = Type&;
+	using CReference = const Type&;
+	using Pointer = Type*;
+	using CPointer = const Type*;
+	using Position = unsigned int;
+	using Size = Position;
+	using Iterator = TIterator<false>;
+	using CIterator = TIterator<true>;
+
+private:
+
+	static constexpr Position InvalidPosition = Position(-1);
+
+	// Atom position of the end() mark, which has no slot
+	static constexpr Position EndSlot = Position(-2);
+
+	// The atoms are laid out like the data, the atom of a slot is the mark of the element in it
+	// The "Mark" is what the iterators point to, the marks of the erased elements are chained in a free list through mAtomPos
+	struct Mark
+	{
+		ID			mIteratorID = 0u;
+		Position	mAtomPos = 0u;
+	};
+
+public:
+
+	// The "Iterator" keep track of data in the array, const iterators (CIterator) only read the elements
+	template <bool TConstness>
+	struct TIterator
+	{
+		// Standard iterator traits
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<TConstness, CPointer, Pointer>;
+		using reference = std::conditional_t<TConstness, CReference, Reference>;
+
+		// The vector seen through the iterator
+		using Parent = std::conditional_t<TConstness, const GapTVector, GapTVector>;
+
+		TIterator() :
+			mParentVector(nullptr),
+			mMarkPos(InvalidPosition),
+			mIteratorID(0u)
+		{
+		}
+
+		// A mutable iterator converts to a const one
+		template <bool TOtherConstness, class = std::enable_if_t<TConstness && !TOtherConstness>>
+		TIterator(const TIterator<TOtherConstness>& Copy) :
+			mParentVector(Copy.mParentVector),
+			mMarkPos(Copy.mMarkPos),
+			mIteratorID(Copy.mIteratorID)
+		{
+		}
+
+		// Create an iterator starting from the element index
+		TIterator(const Position& Index, Parent* ParentVector) :
+			mParentVector(ParentVector),
+			mMarkPos(Index == ParentVector->mVectorSize ? ParentVector->mEndMark : ParentVector->mAtomsVector[ParentVector->slot(Index)]),
+			mIteratorID(ParentVector->mMarksVector[mMarkPos].mIteratorID)
+		{
+		}
+
+		// Indirection
+		reference operator*() const
+		{
+			assert(isValid());
+
+			return mParentVector->element(mParentVector->mMarksVector[mMarkPos].mAtomPos);
+		}
+		pointer operator->() const
+		{
+			return &**this;
+		}
+		reference operator[](const difference_type& Offset) const
+		{
+			return *(*this + Offset);
+		}
+
+		// Arithmetic
+		TIterator& operator++()
+		{
+			return *this = *this + 1;
+		}
+		TIterator& operator--()
+		{
+			return *this = *this - 1;
+		}
+		TIterator operator++(int)
+		{
+			auto Temp = *this;
+			++*this;
+			return Temp;
+		}
+		TIterator operator--(int)
+		{
+			auto Temp = *this;
+			--*this;
+			return Temp;
+		}
+		TIterator& operator+=(const difference_type& Offset)
+		{
+			return *this = *this + Offset;
+		}
+		TIterator& operator-=(const difference_type& Offset)
+		{
+			return *this = *this - Offset;
+		}
+		TIterator operator+(const difference_type& Offset) const
+		{
+			return TIterator(static_cast<Position>(index() + Offset), mParentVector);
+		}
+		friend TIterator operator+(const difference_type& Offset, const TIterator& Right)
+		{
+			return Right + Offset;
+		}
+		TIterator operator-(const difference_type& Offset) const
+		{
+			return TIterator(static_cast<Position>(index() - Offset), mParentVector);
+		}
+		template <bool TOtherConstness>
+		difference_type operator-(const TIterator<TOtherConstness>& Right) const
+		{
+			return static_cast<difference_type>(index()) - static_cast<difference_type>(Right.index());
+		}
+
+		// Comparison
+		template <bool TOtherConstness>
+		bool operator==(const TIterator<TOtherConstness>& Right) const
+		{
+			return index() == Right.index();
+		}
+		template <bool TOtherConstness>
+		bool operator!=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(*this == Right);
+		}
+		template <bool TOtherConstness>
+		bool operator<(const TIterator<TOtherConstness>& Right) const
+		{
+			return index() < Right.index();
+		}
+		template <bool TOtherConstness>
+		bool operator>(const TIterator<TOtherConstness>& Right) const
+		{
+			return Right < *this;
+		}
+		template <bool TOtherConstness>
+		bool operator<=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(Right < *this);
+		}
+		template <bool TOtherConstness>
+		bool operator>=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(*this < Right);
+		}
+
+		// Check if the iterator is valid
+		bool isValid() const
+		{
+			return mParentVector && mParentVector->mMarksVector[mMarkPos].mIteratorID == mIteratorID;
+		}
+
+	private:
+		friend class GapTVector;
+		template <bool TOtherConstness>
+		friend struct TIterator;
+
+		// Index of the element, Mark -> slot
+		Position index() const
+		{
+			auto AtomPos = mParentVector->mMarksVector[mMarkPos].mAtomPos;
+			return AtomPos == EndSlot ? mParentVector->mVectorSize : mParentVector->indexOf(AtomPos);
+		}
+
+		Parent*		mParentVector;
+		Position	mMarkPos;
+		ID			mIteratorID;
+	};
+
+	// Default constructor
+	GapTVector() :
+		mVectorSize(0u),
+		mVectorCapacity(0u),
+		mHead(0u),
+		mGapPos(0u),
+		mEndMark(0u),
+		mFreeMark(InvalidPosition)
+	{
+		// The first mark is the end() iterator
+		mMarksVector.push_back({ 0u, EndSlot });
+	}
+
+	// Copy constructor, the copy has its own iterators
+	GapTVector(const GapTVector& Copy) :
+		GapTVector()
+	{
+		reserve(Copy.mVectorSize);
+		for (auto Index = Size(0); Index < Copy.mVectorSize; ++Index)
+			emplaceBack(Copy[Index]);
+	}
+
+	// Move constructor, the iterators follow the elements
+	// Not noexcept, the empty vector it starts from allocates the mark of its end()
+	GapTVector(GapTVector&& Move) :
+		GapTVector()
+	{
+		swap(Move);
+	}
+
+	~GapTVector()
+	{
+		clear();
+	}
+
+	GapTVector& operator=(GapTVector Copy) noexcept
+	{
+		swap(Copy);
+		return *this;
+	}
+
+#pragma region Element access
+
+	// Access specified element with bounds checking
+	Reference at(const Size& Index)
+	{
+		assert(Index < mVectorSize);
+
+		return element(slot(Index));
+	}
+	CReference at(const Size& Index) const
+	{
+		assert(Index < mVectorSize);
+
+		return element(slot(Index));
+	}
+
+	// Access specified element
+	Reference operator[](const Size& Index)
+	{
+		return element(slot(Index));
+	}
+	CReference operator[](const Size& Index) const
+	{
+		return element(slot(Index));
+	}
+
+	// Access the first element
+	Reference front()
+	{
+		return (*this)[0u];
+	}
+	CReference front() const
+	{
+		return (*this)[0u];
+	}
+
+	// Access the last element
+	Reference back()
+	{
+		return (*this)[mVectorSize - 1];
+	}
+	CReference back() const
+	{
+		return (*this)[mVectorSize - 1];
+	}
+
+#pragma endregion
+
+#pragma region Iterators
+
+	Iterator begin()
+	{
+		return Iterator(0u, this);
+	}
+	CIterator begin() const
+	{
+		return CIterator(0u, this);
+	}
+	CIterator cbegin() const
+	{
+		return begin();
+	}
+
+	Iterator end()
+	{
+		return Iterator(mVectorSize, this);
+	}
+	CIterator end() const
+	{
+		return CIterator(mVectorSize, this);
+	}
+	CIterator cend() const
+	{
+		return end();
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Checks whether the container is empty
+	bool empty() const noexcept
+	{
+		return !mVectorSize;
+	}
+
+	// Returns the number of elements
+	Size size() const noexcept
+	{
+		return mVectorSize;
+	}
+
+	// Returns the number of elements that can be held in currently allocated storage
+	Size capacity() const noexcept
+	{
+		return mVectorCapacity;
+	}
+
+	// Reserves storage, the elements are laid out again with the gap at the end
+	void reserve(const Size& NewCapacity)
+	{
+		if (NewCapacity > mVectorCapacity)
+			growVector(NewCapacity);
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Inserts an element constructed from the passed arguments before pos
+	template <class... TArgs>
+	Iterator emplace(const CIterator& InsertPosition, TArgs&&... Args)
+	{
+		// Construct the element before touching the vector, the arguments may refer to an element that is about to move
+		Type Element(std::forward<TArgs>(Args)...);
+		auto Index = InsertPosition.index();
+
+		if (mVectorSize == mVectorCapacity)
+			growVector(mVectorCapacity ? mVectorCapacity * 2u : 8u);
+		reserveFreeMark();
+		moveGap(Index);
+
+		// The element goes on the left side of the gap, except at the front where the gap stays for the next pushFront
+		auto Slot = Index ? wrap(mHead + Index) : wrap(mHead + gapSize() - 1u);
+		new(mVectorData.get() + Slot) Type(std::move(Element));
+		if (Index)
+			++mGapPos;
+
+		// The old end() mark belongs to the new element, a free mark becomes the new end()
+		mAtomsVector[Slot] = mEndMark;
+		mMarksVector[mEndMark].mAtomPos = Slot;
+		++mVectorSize;
+		mEndMark = takeFreeMark(Position(EndSlot));
+
+		return Iterator(Index, this);
+	}
+	Iterator insert(const CIterator& InsertPosition, const Type& Value)
+	{
+		return emplace(InsertPosition, Value);
+	}
+	Iterator insert(const CIterator& InsertPosition, Type&& Value)
+	{
+		return emplace(InsertPosition, std::move(Value));
+	}
+
+	// Create an element using the passed arguments at the end of the vector
+	template <class... TArgs>
+	Iterator emplaceBack(TArgs&&... Args)
+	{
+		return emplace(end(), std::forward<TArgs>(Args)...);
+	}
+	Iterator pushBack(const Type& Element)
+	{
+		return emplaceBack(Element);
+	}
+	Iterator pushBack(Type&& Element)
+	{
+		return emplaceBack(std::move(Element));
+	}
+
+	// Create an element using the passed arguments at the start of the vector
+	template <class... TArgs>
+	Iterator emplaceFront(TArgs&&... Args)
+	{
+		return emplace(begin(), std::forward<TArgs>(Args)...);
+	}
+	Iterator pushFront(const Type& Element)
+	{
+		return emplaceFront(Element);
+	}
+	Iterator pushFront(Type&& Element)
+	{
+		return emplaceFront(std::move(Element));
+	}
+
+	// Removes specified elements from the container
+	Iterator erase(const CIterator& DeletePosition)
+	{
+		if (DeletePosition == end())
+			return end();
+
+		auto Index = DeletePosition.index();
+		auto DeletedMark = DeletePosition.mMarkPos;
+
+		// Bring the gap next to the element from the cheaper side, then let the gap swallow it
+		Position Slot;
+		if (gapDistance(Index + 1u) < gapDistance(Index))
+		{
+			moveGap(Index + 1u);
+			Slot = wrap(mHead + Index);
+			--mGapPos;
+		}
+		else
+		{
+			moveGap(Index);
+			Slot = wrap(mHead + Index + gapSize());
+		}
+
+		element(Slot).~Type();
+		--mVectorSize;
+
+		// Invalidates the connected mark
+		releaseMark(DeletedMark);
+
+		return Iterator(Index, this);
+	}
+	Iterator erase(const CIterator& First, const CIterator& Last)
+	{
+		auto FirstIndex = First.index();
+		for (auto Index = Last.index(); Index > FirstIndex; --Index)
+			erase(Iterator(static_cast<Position>(Index - 1), this));
+
+		return Iterator(FirstIndex, this);
+	}
+
+	// Remove the last element in the vector
+	void popBack()
+	{
+		assert(mVectorSize);
+
+		erase(Iterator(mVectorSize - 1, this));
+	}
+
+	// Remove the first element in the vector
+	void popFront()
+	{
+		assert(mVectorSize);
+
+		erase(begin());
+	}
+
+	// Clears the contents, the iterators of the removed elements are invalidated
+	void clear()
+	{
+		for (auto Index = Size(0); Index < mVectorSize; ++Index)
+		{
+			auto Slot = slot(Index);
+			element(Slot).~Type();
+			releaseMark(mAtomsVector[Slot]);
+		}
+
+		mVectorSize = 0u;
+		mHead = 0u;
+		mGapPos = 0u;
+	}
+
+	// Exchanges the contents with another vector, the iterators follow the elements
+	void swap(GapTVector& Other) noexcept
+	{
+		std::swap(mVectorData, Other.mVectorData);
+		std::swap(mAtomsVector, Other.mAtomsVector);
+		std::swap(mMarksVector, Other.mMarksVector);
+		std::swap(mVectorSize, Other.mVectorSize);
+		std::swap(mVectorCapacity, Other.mVectorCapacity);
+		std::swap(mHead, Other.mHead);
+		std::swap(mGapPos, Other.mGapPos);
+		std::swap(mEndMark, Other.mEndMark);
+		std::swap(mFreeMark, Other.mFreeMark);
+	}
+
+#pragma endregion
+
+private:
+
+	Reference element(const Position& Slot)
+	{
+		return reinterpret_cast<Reference>(mVectorData[Slot]);
+	}
+	CReference element(const Position& Slot) const
+	{
+		return reinterpret_cast<CReference>(mVectorData[Slot]);
+	}
+
+	Size gapSize() const
+	{
+		return mVectorCapacity - mVectorSize;
+	}
+
+	// Bring a position below twice the capacity back in the array
+	Position wrap(const Position& Value) const
+	{
+		return Value >= mVectorCapacity ? Value - mVectorCapacity : Value;
+	}
+
+	// Slot of an element, the elements past the gap are shifted by its size
+	Position slot(const Position& Index) const
+	{
+		return wrap(mHead + Index + (Index >= mGapPos ? gapSize() : 0u));
+	}
+
+	// Index of the element in a slot
+	Position indexOf(const Position& Slot) const
+	{
+		auto Offset = wrap(Slot + mVectorCapacity - mHead);
+		return Offset < mGapPos ? Offset : Offset - gapSize();
+	}
+
+	// Number of elements to move to bring the gap to an index, going around the array when it's shorter
+	Size gapDistance(const Position& Index) const
+	{
+		return Index >= mGapPos ? std::min(Index - mGapPos, mGapPos + mVectorSize - Index) : std::min(mGapPos - Index, mVectorSize - mGapPos + Index);
+	}
+
+	// Move the element in a slot to an empty slot and reconnect its mark
+	void moveElement(const Position& Destination, const Position& Source)
+	{
+		TRelocator<Type>::relocate(mVectorData.get() + Destination, mVectorData.get() + Source, 1u);
+		mAtomsVector[Destination] = mAtomsVector[Source];
+		mMarksVector[mAtomsVector[Destination]].mAtomPos = Destination;
+	}
+
+	// Move the gap to an index by the shorter way, a gap at the front and a gap at the back are the same slots
+	void moveGap(const Position& Index)
+	{
+		auto Gap = gapSize();
+		if (!Gap)
+		{
+			mGapPos = Index;
+			return;
+		}
+
+		auto Forward = Index >= mGapPos;
+		if (Forward ? Index - mGapPos > mGapPos + mVectorSize - Index : mGapPos - Index > mVectorSize - mGapPos + Index)
+		{
+			// Go the other way around, through the start and the end of the vector
+			if (Forward)
+			{
+				moveGapLeft(0u);
+				mHead = wrap(mHead + Gap);
+				mGapPos = mVectorSize;
+			}
+			else
+			{
+				moveGapRight(mVectorSize);
+				mHead = wrap(mHead + mVectorCapacity - Gap);
+				mGapPos = 0u;
+			}
+			Forward = !Forward;
+		}
+
+		if (Forward)
+			moveGapRight(Index);
+		else
+			moveGapLeft(Index);
+	}
+
+	// The elements between the gap and the index cross the gap
+	void moveGapRight(const Position& Index)
+	{
+		for (auto Gap = gapSize(); mGapPos < Index; ++mGapPos)
+			moveElement(wrap(mHead + mGapPos), wrap(mHead + mGapPos + Gap));
+	}
+	void moveGapLeft(const Position& Index)
+	{
+		for (auto Gap = gapSize(); mGapPos > Index; --mGapPos)
+			moveElement(wrap(mHead + mGapPos - 1u + Gap), wrap(mHead + mGapPos - 1u));
+	}
+
+	// Reallocate the storage, the elements are laid out from the first slot with the gap after them
+	void growVector(const Size& NewCapacity)
+	{
+		assert(NewCapacity < EndSlot);
+
+		std::unique_ptr<Data[]> NewData(new Data[NewCapacity]);
+		std::vector<Position> NewAtoms(NewCapacity);
+		for (auto Index = Size(0); Index < mVectorSize; ++Index)
+		{
+			auto Slot = slot(Index);
+			TRelocator<Type>::relocate(NewData.get() + Index, mVectorData.get() + Slot, 1u);
+			NewAtoms[Index] = mAtomsVector[Slot];
+			mMarksVector[NewAtoms[Index]].mAtomPos = Index;
+		}
+
+		mVectorData = std::move(NewData);
+		mAtomsVector = std::move(NewAtoms);
+		mVectorCapacity = NewCapacity;
+		mHead = 0u;
+		mGapPos = mVectorSize;
+	}
+
+	// Add a mark to the free list if it's empty, so taking one later can't throw
+	void reserveFreeMark()
+	{
+		if (mFreeMark != InvalidPosition)
+			return;
+
+		mMarksVector.push_back({ 0u, InvalidPosition });
+		mFreeMark = static_cast<Position>(mMarksVector.size() - 1);
+	}
+
+	// Take a mark from the free list and connect it to a slot
+	Position takeFreeMark(const Position& AtomPos)
+	{
+		auto MarkPos = mFreeMark;
+		assert(MarkPos != InvalidPosition);
+
+		mFreeMark = mMarksVector[MarkPos].mAtomPos;
+		mMarksVector[MarkPos].mAtomPos = AtomPos;
+
+		return MarkPos;
+	}
+
+	// Invalidate a mark and put it back in the free list
+	void releaseMark(const Position& MarkPos)
+	{
+		++mMarksVector[MarkPos].mIteratorID;
+		mMarksVector[MarkPos].mAtomPos = mFreeMark;
+		mFreeMark = MarkPos;
+	}
+
+private:
+	std::unique_ptr<Data[]>	mVectorData;
+	std::vector<Position>	mAtomsVector;
+	std::vector<Mark>		mMarksVector;
+	Size					mVectorSize;
+	Size					mVectorCapacity;
+
+	// Slot of the first element when the gap is at the end, and index of the first element after the gap
+	Position				mHead;
+	Position				mGapPos;
+	Position				mEndMark;
+	Position				mFreeMark;
+};
+
+// Specialize the swap function
+template <class Type, class ID>
+void swap(GapTVector<Type, ID>& Left, GapTVector<Type, ID>& Right) noexcept
+{
+	Left.swap(Right);
+}
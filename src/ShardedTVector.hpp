@@ -0,0 +1,350 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#include <array>
+#include <exception>
+#include <mutex>
+#include <shared_mutex>
+
+// Elements spread over independently locked TVector shards, so threads mutating different shards don't wait for each other
+// A handle carries the shard of its element, any thread can resolve it, and the whole container can be visited in parallel
+template <class Type, std::size_t Shards = 16u, class TPosition = unsigned int, class TID = std::uint32_t>
+class ShardedTVector
+{
+	static_assert(Shards > 0u, "ShardedTVector needs at least one shard");
+
+public:
+
+	// Type aliases
+	using Vector = TVector<Type, TPosition, TID>;
+	using Iterator = typename Vector::Iterator;
+	using Size = std::size_t;
+
+	// Number of elements a parallel task visits at most
+	// reduce() reads the chunks of a shard under a shared lock, so a big shard is shared out among the threads
+	// forEach() may write the elements, so the chunks of a shard take its lock one at a time
+	static constexpr Size ChunkSize = 4096u;
+
+	// An element of the container, the iterator of its shard plus the shard index
+	struct Handle
+	{
+		Handle() :
+			mShard(0u)
+		{
+		}
+
+		bool operator==(const Handle& Right) const
+		{
+			return mShard == Right.mShard && mIterator.markPos() == Right.mIterator.markPos() && mIterator.id() == Right.mIterator.id();
+		}
+		bool operator!=(const Handle& Right) const
+		{
+			return !(*this == Right);
+		}
+
+		// The shard that owns the element
+		const Size& shard() const noexcept
+		{
+			return mShard;
+		}
+
+	private:
+		friend class ShardedTVector;
+
+		Handle(const Iterator& Element, const Size& Shard) :
+			mIterator(Element),
+			mShard(Shard)
+		{
+		}
+
+		Iterator	mIterator;
+		Size		mShard;
+	};
+
+	// Default constructor, the parallel visits run on the shared TVectorThreadPool
+	ShardedTVector()
+	{
+		auto& Pool = TVectorThreadPool::shared();
+		mExecutor = [&Pool](std::size_t Count, const std::function<void(std::size_t)>& Task) { Pool.run(Count, Task); };
+	}
+
+	// Construct with the executor of the parallel visits
+	explicit ShardedTVector(TVectorExecutor Executor) :
+		mExecutor(std::move(Executor))
+	{
+		assert(mExecutor);
+	}
+
+	ShardedTVector(const ShardedTVector& Copy) = delete;
+	ShardedTVector& operator=(const ShardedTVector& Copy) = delete;
+
+	// The shard the calling thread appends to, every new thread gets the next one
+	static Size homeShard()
+	{
+		static std::atomic<Size> NextThread(0u);
+		thread_local Size Home = NextThread.fetch_add(1u, std::memory_order_relaxed) % Shards;
+
+		return Home;
+	}
+
+#pragma region Element access
+
+	// Calls Function(Element) with the shard locked, returns false without calling it if the element was erased
+	template <class TFunction>
+	bool visit(const Handle& Element, TFunction&& Function)
+	{
+		auto& Owner = shard(Element);
+		std::lock_guard<Mutex> Lock(Owner.mMutex);
+		if (!Element.mIterator.isValid())
+			return false;
+
+		Function(*Element.mIterator);
+		return true;
+	}
+
+	// Checks whether the element of a handle is still in the container
+	bool isValid(const Handle& Element) const
+	{
+		auto& Owner = shard(Element);
+		std::shared_lock<Mutex> Lock(Owner.mMutex);
+
+		return Element.mIterator.isValid();
+	}
+
+	// Calls Function(Vector) with a shard locked, to make many changes to it at once
+	// The iterators of the shard vector become handles with makeHandle()
+	template <class TFunction>
+	void withShard(const Size& ShardIndex, TFunction&& Function)
+	{
+		assert(ShardIndex < Shards);
+
+		std::lock_guard<Mutex> Lock(mShards[ShardIndex].mMutex);
+		Function(mShards[ShardIndex].mVector);
+	}
+
+	// Turns an iterator of a shard vector into a handle
+	Handle makeHandle(const Iterator& Element, const Size& ShardIndex) const
+	{
+		assert(ShardIndex < Shards);
+
+		return Handle(Element, ShardIndex);
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Returns the number of elements, the shards are counted one after the other
+	Size size() const
+	{
+		auto Count = Size(0);
+		for (auto& Owner : mShards)
+		{
+			std::shared_lock<Mutex> Lock(Owner.mMutex);
+			Count += Owner.mVector.size();
+		}
+
+		return Count;
+	}
+
+	// Returns the number of shards
+	static constexpr Size shards() noexcept
+	{
+		return Shards;
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Create an element at the end of the calling thread's shard
+	template <class... TArgs>
+	Handle emplaceBack(TArgs&&... Args)
+	{
+		return emplaceBackTo(homeShard(), std::forward<TArgs>(Args)...);
+	}
+	Handle pushBack(const Type& Element)
+	{
+		return emplaceBack(Element);
+	}
+	Handle pushBack(Type&& Element)
+	{
+		return emplaceBack(std::move(Element));
+	}
+
+	// Create an element at the end of a specific shard
+	template <class... TArgs>
+	Handle emplaceBackTo(const Size& ShardIndex, TArgs&&... Args)
+	{
+		assert(ShardIndex < Shards);
+
+		auto& Owner = mShards[ShardIndex];
+		std::lock_guard<Mutex> Lock(Owner.mMutex);
+
+		return Handle(Owner.mVector.emplaceBack(std::forward<TArgs>(Args)...), ShardIndex);
+	}
+
+	// Removes an element, returns false if it was already erased
+	bool erase(const Handle& Element)
+	{
+		auto& Owner = shard(Element);
+		std::lock_guard<Mutex> Lock(Owner.mMutex);
+		if (!Element.mIterator.isValid())
+			return false;
+
+		Owner.mVector.erase(Element.mIterator);
+		return true;
+	}
+
+	// Clears the contents, the shards are cleared one after the other
+	void clear()
+	{
+		for (auto& Owner : mShards)
+		{
+			std::lock_guard<Mutex> Lock(Owner.mMutex);
+			Owner.mVector.clear();
+		}
+	}
+
+#pragma endregion
+
+#pragma region Parallel algorithms
+
+	// Calls Function(Element) for every element, chunks of the shards are visited in parallel with their shard locked
+	// Function must not use the executor, and the first exception it throws is rethrown once every chunk is done
+	template <class TFunction>
+	void forEach(TFunction&& Function)
+	{
+		runChunks<std::unique_lock<Mutex>>([&Function](Vector& Owner, const Size& First, const Size& Last)
+		{
+			for (auto Index = First; Index < Last; ++Index)
+				Function(Owner[static_cast<TPosition>(Index)]);
+		});
+	}
+
+	// Returns Reduce(Identity, Transform(Element)...) over every element, every chunk reduces its elements and the chunks are reduced in order
+	// Reduce must be associative, the exceptions are handled as in forEach
+	template <class TResult, class TReduce, class TTransform>
+	TResult reduce(TResult Identity, TReduce&& Reduce, TTransform&& Transform)
+	{
+		std::vector<TResult> Partials;
+		runChunks<std::shared_lock<Mutex>>([&](Vector& Owner, const Size& First, const Size& Last, const Size& Chunk)
+		{
+			auto& Elements = static_cast<const Vector&>(Owner);
+			auto Partial = Identity;
+			for (auto Index = First; Index < Last; ++Index)
+				Partial = Reduce(std::move(Partial), Transform(Elements[static_cast<TPosition>(Index)]));
+			Partials[Chunk] = std::move(Partial);
+		}, [&](const Size& Chunks) { Partials.assign(Chunks, Identity); });
+
+		for (auto& Partial : Partials)
+			Identity = Reduce(std::move(Identity), std::move(Partial));
+
+		return Identity;
+	}
+
+#pragma endregion
+
+private:
+
+	// Readers of a shard share its lock, the writers take it alone
+	using Mutex = std::shared_timed_mutex;
+
+	struct alignas(64) Shard
+	{
+		mutable Mutex	mMutex;
+		Vector			mVector;
+	};
+
+	Shard& shard(const Handle& Element)
+	{
+		assert(Element.mShard < Shards);
+		return mShards[Element.mShard];
+	}
+	const Shard& shard(const Handle& Element) const
+	{
+		assert(Element.mShard < Shards);
+		return mShards[Element.mShard];
+	}
+
+	// Split the shards in chunks and run Visit(Vector, First, Last) for each one on the executor, holding a TLock on its shard
+	template <class TLock, class TVisit>
+	void runChunks(TVisit&& Visit)
+	{
+		runChunks<TLock>([&Visit](Vector& Owner, const Size& First, const Size& Last, const Size&) { Visit(Owner, First, Last); }, [](const Size&) {});
+	}
+
+	// Same, passing also the chunk index, Prepare(Chunks) is called before the chunks run
+	template <class TLock, class TVisit, class TPrepare>
+	void runChunks(TVisit&& Visit, TPrepare&& Prepare)
+	{
+		// The first chunk of every shard, the sizes may change until the chunks lock their shard
+		std::array<Size, Shards + 1u> FirstChunk;
+		FirstChunk[0] = 0u;
+		for (auto ShardIndex = Size(0); ShardIndex < Shards; ++ShardIndex)
+		{
+			std::shared_lock<Mutex> Lock(mShards[ShardIndex].mMutex);
+			FirstChunk[ShardIndex + 1u] = FirstChunk[ShardIndex] + (mShards[ShardIndex].mVector.size() + ChunkSize - 1u) / ChunkSize;
+		}
+
+		auto Chunks = FirstChunk[Shards];
+		Prepare(Chunks);
+		if (!Chunks)
+			return;
+
+		// The executor tasks must not throw, the first exception is kept for later
+		std::mutex ErrorMutex;
+		std::exception_ptr Error;
+		mExecutor(Chunks, [&](std::size_t Chunk)
+		{
+			auto ShardIndex = static_cast<Size>(std::upper_bound(FirstChunk.begin(), FirstChunk.end(), Chunk) - FirstChunk.begin() - 1);
+			auto& Owner = mShards[ShardIndex];
+			try
+			{
+				TLock Lock(Owner.mMutex);
+
+				// The shard may have shrunk since it was split
+				auto First = (Chunk - FirstChunk[ShardIndex]) * ChunkSize;
+				auto Last = std::min<Size>(First + ChunkSize, Owner.mVector.size());
+				if (First < Last)
+					Visit(Owner.mVector, First, Last, Chunk);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> Lock(ErrorMutex);
+				if (!Error)
+					Error = std::current_exception();
+			}
+		});
+
+		if (Error)
+			std::rethrow_exception(Error);
+	}
+
+private:
+	std::array<Shard, Shards>	mShards;
+	TVectorExecutor				mExecutor;
+};
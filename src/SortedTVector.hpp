@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#include <algorithm>
+#include <functional>
+
+// A TVector that keeps its elements ordered, the iterators it returns stay valid like the TVector ones
+template <class Type, class Compare = std::less<Type>>
+class SortedTVector
+{
+public:
+
+	// Type aliases
+	using Vector = TVector<Type>;
+	using CIterator = typename Vector::CIterator;
+	using CReference = typename Vector::CReference;
+	using CPointer = typename Vector::CPointer;
+	using Size = typename Vector::Size;
+
+	// Default constructor
+	SortedTVector(const Compare& Comp = Compare()) :
+		mCompare(Comp),
+		mSearchIndexEnabled(false),
+		mSearchIndexDirty(true)
+	{
+	}
+
+#pragma region Element access
+
+	// Access specified element
+	CReference operator[](const Size& Index) const
+	{
+		return mVector[Index];
+	}
+
+	// Direct access to the underlying sorted array
+	CPointer data() const
+	{
+		return mVector.data();
+	}
+
+	// Access the underlying vector
+	const Vector& vector() const noexcept
+	{
+		return mVector;
+	}
+
+#pragma endregion
+
+#pragma region Iterators
+
+	// Only const iterators are given out, a write through them could break the order and the search index
+	CIterator begin() const
+	{
+		return vector().begin();
+	}
+
+	CIterator end() const
+	{
+		return vector().end();
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Checks whether the container is empty
+	bool empty() const noexcept
+	{
+		return !mVector.size();
+	}
+
+	// Returns the number of elements
+	const Size& size() const noexcept
+	{
+		return mVector.size();
+	}
+
+	// Reserves storage
+	void reserve(const Size& NewCapacity)
+	{
+		mVector.reserve(NewCapacity);
+	}
+
+#pragma endregion
+
+#pragma region Lookup
+
+	// Returns an iterator to the first element equivalent to value, or end()
+	template <class Key>
+	CIterator find(const Key& Value) const
+	{
+		auto Index = lowerBoundIndex(Value);
+
+		if (Index < mVector.size() && !mCompare(Value, vector()[Index]))
+			return begin() + Index;
+
+		return end();
+	}
+
+	// Returns an iterator to the first element not less than value
+	template <class Key>
+	CIterator lowerBound(const Key& Value) const
+	{
+		return begin() + lowerBoundIndex(Value);
+	}
+
+	// Returns an iterator to the first element greater than value
+	template <class Key>
+	CIterator upperBound(const Key& Value) const
+	{
+		return begin() + upperBoundIndex(Value);
+	}
+
+	// Returns the range of elements equivalent to value
+	template <class Key>
+	std::pair<CIterator, CIterator> equalRange(const Key& Value) const
+	{
+		return { lowerBound(Value), upperBound(Value) };
+	}
+
+	// Enables an Eytzinger ordered copy of the elements to speed up searches on big vectors, it's rebuilt by the first search after a modification
+	void enableSearchIndex(bool Enable)
+	{
+		mSearchIndexEnabled = Enable;
+		mSearchIndexDirty = true;
+
+		// Free the memory used by the index
+		if (!Enable)
+		{
+			std::vector<Type>().swap(mSearchIndex);
+			std::vector<Size>().swap(mSearchIndexPos);
+		}
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Inserts value after the equivalent elements already in the vector
+	CIterator insert(const Type& Value)
+	{
+		auto Index = upperBoundIndex(Value);
+		mSearchIndexDirty = true;
+
+		return mVector.emplace(mVector.begin() + Index, Value);
+	}
+	CIterator insert(Type&& Value)
+	{
+		auto Index = upperBoundIndex(Value);
+		mSearchIndexDirty = true;
+
+		return mVector.emplace(mVector.begin() + Index, std::move(Value));
+	}
+
+	// Inserts the sorted range [first, last) with a single merge pass, returns the number of inserted elements
+	template <class BidirIt>
+	Size insertSorted(BidirIt First, BidirIt Last)
+	{
+		// The range must be sorted by the same criteria of the vector
+		assert(std::is_sorted(First, Last, mCompare));
+
+		mSearchIndexDirty = true;
+
+		return mVector.mergeSorted(First, Last, mCompare);
+	}
+
+	// Removes specified elements from the container
+	CIterator erase(const CIterator& DeletePosition)
+	{
+		mSearchIndexDirty = true;
+
+		return mVector.erase(DeletePosition);
+	}
+	CIterator erase(const CIterator& First, const CIterator& Last)
+	{
+		mSearchIndexDirty = true;
+
+		return mVector.erase(First, Last);
+	}
+
+	// Clears the contents
+	void clear() noexcept
+	{
+		mSearchIndexDirty = true;
+
+		mVector.clear();
+	}
+
+#pragma endregion
+
+private:
+
+	// Branchless binary search of the first element for which Predicate(Element) is false
+	template <class Predicate>
+	Size partitionPoint(Predicate&& IsBefore) const
+	{
+		// Use the Eytzinger index if there is one
+		if (mSearchIndexEnabled)
+			return eytzingerPartitionPoint(IsBefore);
+
+		auto Length = mVector.size();
+		if (!Length)
+			return 0u;
+
+		// Halve the range at every step, the compiler turns the selection into a conditional move
+		// The elements are read through the const vector, a lookup must not look like a write to it
+		auto Base = vector().data();
+		while (Length > 1)
+		{
+			auto Half = Length / 2;
+			Base = IsBefore(Base[Half]) ? Base + Half : Base;
+			Length -= Half;
+		}
+
+		return static_cast<Size>(Base - vector().data()) + (IsBefore(*Base) ? 1u : 0u);
+	}
+
+	// Same search over the Eytzinger ordered index, the next levels to visit are always close in memory
+	template <class Predicate>
+	Size eytzingerPartitionPoint(Predicate& IsBefore) const
+	{
+		if (mSearchIndexDirty)
+			rebuildSearchIndex();
+
+		// Go down the implicit tree, left when the element is not before the searched one
+		auto Length = mVector.size();
+		auto Node = std::size_t(1);
+		while (Node <= Length)
+			Node = 2 * Node + (IsBefore(mSearchIndex[Node]) ? 1 : 0);
+
+		// Go back up to the last node where we turned left
+		while (Node & 1)
+			Node >>= 1;
+		Node >>= 1;
+
+		return Node ? mSearchIndexPos[Node] : Length;
+	}
+
+	// Copy the elements in Eytzinger order (a breadth first layout of the binary search tree, 1 based)
+	void rebuildSearchIndex() const
+	{
+		mSearchIndex.resize(mVector.size() + 1);
+		mSearchIndexPos.resize(mVector.size() + 1);
+
+		Size SortedIndex = 0u;
+		fillSearchIndex(SortedIndex, 1u);
+
+		mSearchIndexDirty = false;
+	}
+	void fillSearchIndex(Size& SortedIndex, const std::size_t& Node) const
+	{
+		if (Node > mVector.size())
+			return;
+
+		// In order visit of the implicit tree
+		fillSearchIndex(SortedIndex, 2 * Node);
+		mSearchIndex[Node] = vector()[SortedIndex];
+		mSearchIndexPos[Node] = SortedIndex++;
+		fillSearchIndex(SortedIndex, 2 * Node + 1);
+	}
+
+	// Index of the first element not less than value
+	template <class Key>
+	Size lowerBoundIndex(const Key& Value) const
+	{
+		return partitionPoint([this, &Value](const Type& Element) { return mCompare(Element, Value); });
+	}
+
+	// Index of the first element greater than value
+	template <class Key>
+	Size upperBoundIndex(const Key& Value) const
+	{
+		return partitionPoint([this, &Value](const Type& Element) { return !mCompare(Value, Element); });
+	}
+
+private:
+	Vector	mVector;
+	Compare	mCompare;
+
+	// Eytzinger ordered copy of the elements and their position in the vector, lazily rebuilt by the const lookups
+	bool						mSearchIndexEnabled;
+	mutable bool				mSearchIndexDirty;
+	mutable std::vector<Type>	mSearchIndex;
+	mutable std::vector<Size>	mSearchIndexPos;
+};
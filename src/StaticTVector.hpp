@@ -0,0 +1,662 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+// Smallest unsigned type that holds every position of a table of Capacity + 1 entries, plus an invalid position
+template <std::size_t Capacity>
+using StaticPosition = std::conditional_t<(Capacity < 0xFFu), std::uint8_t, std::conditional_t<(Capacity < 0xFFFFu), std::uint16_t, std::uint32_t>>;
+
+// Inline storage of the elements, trivial types are kept in a plain array so the whole vector can be used in constant expressions
+template <class Type, std::size_t Capacity, bool IsTrivial = std::is_trivial<Type>::value>
+class StaticTVectorStorage
+{
+protected:
+	using Position = StaticPosition<Capacity>;
+
+	constexpr StaticTVectorStorage() :
+		mData{},
+		mVectorSize(0u)
+	{
+	}
+
+	template <class... TArgs>
+	constexpr void construct(const Position& Index, TArgs&&... Args)
+	{
+		mData[Index] = Type(std::forward<TArgs>(Args)...);
+	}
+
+	constexpr void destroy(const Position&)
+	{
+	}
+
+	// Move an element to an empty slot, the source slot becomes empty
+	constexpr void relocate(const Position& Destination, const Position& Source)
+	{
+		mData[Destination] = mData[Source];
+	}
+
+	constexpr Type& element(const Position& Index)
+	{
+		return mData[Index];
+	}
+	constexpr const Type& element(const Position& Index) const
+	{
+		return mData[Index];
+	}
+
+	constexpr Type* pointer()
+	{
+		return mData;
+	}
+	constexpr const Type* pointer() const
+	{
+		return mData;
+	}
+
+	Type		mData[Capacity ? Capacity : 1];
+	Position	mVectorSize;
+};
+
+// Inline storage of the elements for types with constructors or destructors that do some work
+template <class Type, std::size_t Capacity>
+class StaticTVectorStorage<Type, Capacity, false>
+{
+protected:
+	using Position = StaticPosition<Capacity>;
+	using Data = std::aligned_storage_t<sizeof(Type), alignof(Type)>;
+
+	StaticTVectorStorage() :
+		mVectorSize(0u)
+	{
+	}
+
+	StaticTVectorStorage(const StaticTVectorStorage& Copy) :
+		mVectorSize(0u)
+	{
+		for (; mVectorSize < Copy.mVectorSize; ++mVectorSize)
+			construct(mVectorSize, Copy.element(mVectorSize));
+	}
+
+	StaticTVectorStorage& operator=(const StaticTVectorStorage& Copy)
+	{
+		if (this == &Copy)
+			return *this;
+
+		// Assign the common elements, then construct or destroy the rest
+		auto Common = mVectorSize < Copy.mVectorSize ? mVectorSize : Copy.mVectorSize;
+		for (Position Index = 0u; Index < Common; ++Index)
+			element(Index) = Copy.element(Index);
+		for (; mVectorSize < Copy.mVectorSize; ++mVectorSize)
+			construct(mVectorSize, Copy.element(mVectorSize));
+		while (mVectorSize > Copy.mVectorSize)
+			destroy(--mVectorSize);
+
+		return *this;
+	}
+
+	~StaticTVectorStorage()
+	{
+		for (Position Index = 0u; Index < mVectorSize; ++Index)
+			destroy(Index);
+	}
+
+	template <class... TArgs>
+	void construct(const Position& Index, TArgs&&... Args)
+	{
+		new(mData + Index) Type(std::forward<TArgs>(Args)...);
+	}
+
+	void destroy(const Position& Index)
+	{
+		element(Index).~Type();
+	}
+
+	// Move an element to an empty slot, the source slot becomes empty
+	void relocate(const Position& Destination, const Position& Source) noexcept
+	{
+		TRelocator<Type>::relocate(mData + Destination, mData + Source, 1);
+	}
+
+	Type& element(const Position& Index)
+	{
+		return reinterpret_cast<Type&>(mData[Index]);
+	}
+	const Type& element(const Position& Index) const
+	{
+		return reinterpret_cast<const Type&>(mData[Index]);
+	}
+
+	Type* pointer()
+	{
+		return reinterpret_cast<Type*>(mData);
+	}
+	const Type* pointer() const
+	{
+		return reinterpret_cast<const Type*>(mData);
+	}
+
+	Data		mData[Capacity ? Capacity : 1];
+	Position	mVectorSize;
+};
+
+// A TVector with a capacity fixed at compile time, all the storage is inline and nothing is allocated
+// The positions use the smallest type that fits the capacity, ID is the type of the iterator IDs (a smaller one wraps around sooner)
+template <class Type, std::size_t Capacity, class ID = std::uint16_t>
+class StaticTVector : private StaticTVectorStorage<Type, Capacity>
+{
+	using Storage = StaticTVectorStorage<Type, Capacity>;
+
+	// Elements are shifted in place, a shift can't be undone half way
+	static_assert(TRelocator<Type>::IsNoexcept, "StaticTVector elements must be relocatable without throwing");
+
+	using Storage::mVectorSize;
+
+	struct Atom;
+	struct Mark;
+
+public:
+
+	template <bool TConstness>
+	struct TIterator;
+
+	// Type aliases
+	using Reference = Type&;
+	using CReference = const Type&;
+	using Pointer = Type*;
+	using CPointer = const Type*;
+	using Position = StaticPosition<Capacity>;
+	using Size = Position;
+	using Iterator = TIterator<false>;
+	using CIterator = TIterator<true>;
+
+private:
+
+	static constexpr Position InvalidPosition = Position(-1);
+
+	// The "Atom" creates a link between the data in the array and the mark
+	struct Atom
+	{
+		Position mDataPos = 0u;
+		Position mMarkPos = 0u;
+	};
+
+	// The "Mark" is what the iterators point to, the marks of the erased elements are chained in a free list through mAtomPos
+	struct Mark
+	{
+		ID			mIteratorID = 0u;
+		Position	mAtomPos = 0u;
+	};
+
+public:
+
+	// The "Iterator" keep track of data in the array, const iterators (CIterator) only read the elements
+	template <bool TConstness>
+	struct TIterator
+	{
+		// Standard iterator traits
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<TConstness, CPointer, Pointer>;
+		using reference = std::conditional_t<TConstness, CReference, Reference>;
+
+		// The vector seen through the iterator
+		using Parent = std::conditional_t<TConstness, const StaticTVector, StaticTVector>;
+
+		constexpr TIterator() :
+			mParentVector(nullptr),
+			mMarkPos(InvalidPosition),
+			mIteratorID(0u)
+		{
+		}
+
+		// A mutable iterator converts to a const one
+		template <bool TOtherConstness, class = std::enable_if_t<TConstness && !TOtherConstness>>
+		constexpr TIterator(const TIterator<TOtherConstness>& Copy) :
+			mParentVector(Copy.mParentVector),
+			mMarkPos(Copy.mMarkPos),
+			mIteratorID(Copy.mIteratorID)
+		{
+		}
+
+		// Create an iterator starting from the data position
+		constexpr TIterator(const Position& DataPosition, Parent* ParentVector) :
+			mParentVector(ParentVector),
+			mMarkPos(ParentVector->mAtomsVector[DataPosition].mMarkPos),
+			mIteratorID(ParentVector->mMarksVector[mMarkPos].mIteratorID)
+		{
+		}
+
+		// Indirection
+		constexpr reference operator*() const
+		{
+			assert(isValid());
+
+			return mParentVector->element(index());
+		}
+		constexpr pointer operator->() const
+		{
+			return &**this;
+		}
+		constexpr reference operator[](const difference_type& Offset) const
+		{
+			return *(*this + Offset);
+		}
+
+		// Arithmetic
+		constexpr TIterator& operator++()
+		{
+			return *this = *this + 1;
+		}
+		constexpr TIterator& operator--()
+		{
+			return *this = *this - 1;
+		}
+		constexpr TIterator operator++(int)
+		{
+			auto Temp = *this;
+			++*this;
+			return Temp;
+		}
+		constexpr TIterator operator--(int)
+		{
+			auto Temp = *this;
+			--*this;
+			return Temp;
+		}
+		constexpr TIterator& operator+=(const difference_type& Offset)
+		{
+			return *this = *this + Offset;
+		}
+		constexpr TIterator& operator-=(const difference_type& Offset)
+		{
+			return *this = *this - Offset;
+		}
+		constexpr TIterator operator+(const difference_type& Offset) const
+		{
+			return TIterator(static_cast<Position>(index() + Offset), mParentVector);
+		}
+		friend constexpr TIterator operator+(const difference_type& Offset, const TIterator& Right)
+		{
+			return Right + Offset;
+		}
+		constexpr TIterator operator-(const difference_type& Offset) const
+		{
+			return TIterator(static_cast<Position>(index() - Offset), mParentVector);
+		}
+		template <bool TOtherConstness>
+		constexpr difference_type operator-(const TIterator<TOtherConstness>& Right) const
+		{
+			return static_cast<difference_type>(index()) - static_cast<difference_type>(Right.index());
+		}
+
+		// Comparison
+		template <bool TOtherConstness>
+		constexpr bool operator==(const TIterator<TOtherConstness>& Right) const
+		{
+			return index() == Right.index();
+		}
+		template <bool TOtherConstness>
+		constexpr bool operator!=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(*this == Right);
+		}
+		template <bool TOtherConstness>
+		constexpr bool operator<(const TIterator<TOtherConstness>& Right) const
+		{
+			return index() < Right.index();
+		}
+		template <bool TOtherConstness>
+		constexpr bool operator>(const TIterator<TOtherConstness>& Right) const
+		{
+			return Right < *this;
+		}
+		template <bool TOtherConstness>
+		constexpr bool operator<=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(Right < *this);
+		}
+		template <bool TOtherConstness>
+		constexpr bool operator>=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(*this < Right);
+		}
+
+		// Check if the iterator is valid
+		constexpr bool isValid() const
+		{
+			return mParentVector && mParentVector->mMarksVector[mMarkPos].mIteratorID == mIteratorID;
+		}
+
+	private:
+		friend class StaticTVector;
+		template <bool TOtherConstness>
+		friend struct TIterator;
+
+		// Position in the data array, Mark -> Atom
+		constexpr Position index() const
+		{
+			return mParentVector->mAtomsVector[mParentVector->mMarksVector[mMarkPos].mAtomPos].mDataPos;
+		}
+
+		Parent*		mParentVector;
+		Position	mMarkPos;
+		ID			mIteratorID;
+	};
+
+	// Default constructor
+	constexpr StaticTVector() :
+		mAtomsVector{},
+		mMarksVector{},
+		mEndMark(0u),
+		mFreeMark(Capacity ? 1u : InvalidPosition)
+	{
+		// The first mark is the end() iterator, all the others are free
+		for (std::size_t MarkPos = 1u; MarkPos <= Capacity; ++MarkPos)
+			mMarksVector[MarkPos].mAtomPos = MarkPos < Capacity ? static_cast<Position>(MarkPos + 1) : InvalidPosition;
+	}
+
+#pragma region Element access
+
+	// Access specified element with bounds checking
+	constexpr Reference at(const Size& Index)
+	{
+		assert(Index < mVectorSize);
+
+		return element(Index);
+	}
+	constexpr CReference at(const Size& Index) const
+	{
+		assert(Index < mVectorSize);
+
+		return element(Index);
+	}
+
+	// Access specified element
+	constexpr Reference operator[](const Size& Index)
+	{
+		return element(Index);
+	}
+	constexpr CReference operator[](const Size& Index) const
+	{
+		return element(Index);
+	}
+
+	// Access the first element
+	constexpr Reference front()
+	{
+		return element(0u);
+	}
+	constexpr CReference front() const
+	{
+		return element(0u);
+	}
+
+	// Access the last element
+	constexpr Reference back()
+	{
+		return element(mVectorSize - 1);
+	}
+	constexpr CReference back() const
+	{
+		return element(mVectorSize - 1);
+	}
+
+	// Direct access to the underlying array
+	constexpr Pointer data() noexcept
+	{
+		return Storage::pointer();
+	}
+	constexpr CPointer data() const noexcept
+	{
+		return Storage::pointer();
+	}
+
+#pragma endregion
+
+#pragma region Iterators
+
+	constexpr Iterator begin()
+	{
+		return Iterator(0u, this);
+	}
+	constexpr CIterator begin() const
+	{
+		return CIterator(0u, this);
+	}
+	constexpr CIterator cbegin() const
+	{
+		return begin();
+	}
+
+	constexpr Iterator end()
+	{
+		return Iterator(mVectorSize, this);
+	}
+	constexpr CIterator end() const
+	{
+		return CIterator(mVectorSize, this);
+	}
+	constexpr CIterator cend() const
+	{
+		return end();
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Checks whether the container is empty
+	constexpr bool empty() const noexcept
+	{
+		return !mVectorSize;
+	}
+
+	// Returns the number of elements
+	constexpr Size size() const noexcept
+	{
+		return mVectorSize;
+	}
+
+	// Returns the maximum possible number of elements, the same as the capacity
+	static constexpr Size max_size() noexcept
+	{
+		return static_cast<Size>(Capacity);
+	}
+
+	// Returns the number of elements that can be held in the storage
+	static constexpr Size capacity() noexcept
+	{
+		return static_cast<Size>(Capacity);
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Create an element using the passed arguments at the end of the vector
+	template <class... TArgs>
+	constexpr Iterator emplaceBack(TArgs&&... Args)
+	{
+		assert(mVectorSize < Capacity);
+
+		Storage::construct(mVectorSize, std::forward<TArgs>(Args)...);
+
+		// The end() iterator structure (atom, mark) belongs to the new element, a free mark becomes the new end()
+		++mVectorSize;
+		mEndMark = takeFreeMark(mVectorSize);
+		mAtomsVector[mVectorSize] = { mVectorSize, mEndMark };
+
+		return Iterator(mVectorSize - 1, this);
+	}
+
+	// Copy/move the passed element in at the end of the vector
+	constexpr Iterator pushBack(const Type& Element)
+	{
+		return emplaceBack(Element);
+	}
+	constexpr Iterator pushBack(Type&& Element)
+	{
+		return emplaceBack(std::move(Element));
+	}
+
+	// Inserts an element constructed from the passed arguments before pos
+	template <class... TArgs>
+	constexpr Iterator emplace(const CIterator& InsertPosition, TArgs&&... Args)
+	{
+		if (InsertPosition == end())
+			return emplaceBack(std::forward<TArgs>(Args)...);
+
+		assert(mVectorSize < Capacity);
+
+		// Construct the element before touching the vector, so a throwing constructor leaves it unchanged
+		Type Element(std::forward<TArgs>(Args)...);
+		auto Index = InsertPosition.index();
+
+		// Shift the elements and their atoms to the right, the end() atom included
+		mAtomsVector[mVectorSize + 1] = { static_cast<Position>(mVectorSize + 1), mEndMark };
+		mMarksVector[mEndMark].mAtomPos = mVectorSize + 1;
+		for (auto AtomPos = mVectorSize; AtomPos > Index; --AtomPos)
+		{
+			Storage::relocate(AtomPos, AtomPos - 1);
+			mAtomsVector[AtomPos] = { AtomPos, mAtomsVector[AtomPos - 1].mMarkPos };
+			mMarksVector[mAtomsVector[AtomPos].mMarkPos].mAtomPos = AtomPos;
+		}
+
+		// The old end() mark belongs to the new element, a free mark becomes the new end()
+		Storage::construct(Index, std::move(Element));
+		mAtomsVector[Index] = { Index, mEndMark };
+		mMarksVector[mEndMark].mAtomPos = Index;
+		++mVectorSize;
+		mEndMark = takeFreeMark(mVectorSize);
+		mAtomsVector[mVectorSize].mMarkPos = mEndMark;
+
+		return Iterator(Index, this);
+	}
+	constexpr Iterator insert(const CIterator& InsertPosition, const Type& Value)
+	{
+		return emplace(InsertPosition, Value);
+	}
+	constexpr Iterator insert(const CIterator& InsertPosition, Type&& Value)
+	{
+		return emplace(InsertPosition, std::move(Value));
+	}
+
+	// Removes specified elements from the container
+	constexpr Iterator erase(const CIterator& DeletePosition)
+	{
+		if (DeletePosition == end())
+			return end();
+
+		auto Index = DeletePosition.index();
+		auto DeletedMark = DeletePosition.mMarkPos;
+
+		// Destroy the element, then shift the rest of the elements and their atoms to the left, the end() atom included
+		Storage::destroy(Index);
+		for (auto AtomPos = Index; AtomPos < mVectorSize; ++AtomPos)
+		{
+			if (AtomPos + 1 < mVectorSize)
+				Storage::relocate(AtomPos, AtomPos + 1);
+
+			mAtomsVector[AtomPos] = { AtomPos, mAtomsVector[AtomPos + 1].mMarkPos };
+			mMarksVector[mAtomsVector[AtomPos].mMarkPos].mAtomPos = AtomPos;
+		}
+		--mVectorSize;
+
+		// Invalidates the connected mark
+		releaseMark(DeletedMark);
+
+		return Iterator(Index, this);
+	}
+	constexpr Iterator erase(const CIterator& First, const CIterator& Last)
+	{
+		auto FirstIndex = First.index();
+		for (auto Index = Last.index(); Index > FirstIndex; --Index)
+			erase(Iterator(static_cast<Position>(Index - 1), this));
+
+		return Iterator(FirstIndex, this);
+	}
+
+	// Remove the last element in the vector
+	constexpr void popBack()
+	{
+		assert(mVectorSize);
+
+		erase(Iterator(mVectorSize - 1, this));
+	}
+
+	// Clears the contents, the iterators of the removed elements are invalidated
+	constexpr void clear()
+	{
+		for (Position Index = 0u; Index < mVectorSize; ++Index)
+		{
+			Storage::destroy(Index);
+			releaseMark(mAtomsVector[Index].mMarkPos);
+		}
+
+		mVectorSize = 0u;
+		mAtomsVector[0] = { 0u, mEndMark };
+		mMarksVector[mEndMark].mAtomPos = 0u;
+	}
+
+#pragma endregion
+
+private:
+
+	constexpr Reference element(const Position& Index)
+	{
+		return Storage::element(Index);
+	}
+	constexpr CReference element(const Position& Index) const
+	{
+		return Storage::element(Index);
+	}
+
+	// Take a mark from the free list and connect it to an atom
+	constexpr Position takeFreeMark(const Position& AtomPos)
+	{
+		auto MarkPos = mFreeMark;
+		assert(MarkPos != InvalidPosition);
+
+		mFreeMark = mMarksVector[MarkPos].mAtomPos;
+		mMarksVector[MarkPos].mAtomPos = AtomPos;
+
+		return MarkPos;
+	}
+
+	// Invalidate a mark and put it back in the free list
+	constexpr void releaseMark(const Position& MarkPos)
+	{
+		++mMarksVector[MarkPos].mIteratorID;
+		mMarksVector[MarkPos].mAtomPos = mFreeMark;
+		mFreeMark = MarkPos;
+	}
+
+private:
+	Atom		mAtomsVector[Capacity + 1];
+	Mark		mMarksVector[Capacity + 1];
+	Position	mEndMark;
+	Position	mFreeMark;
+};
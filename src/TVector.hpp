@@ -24,29 +24,660 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TVECTOR_SSE2
+#include <emmintrin.h>
+#endif
+
+// Kinds of mutation reported to a TVectorObserver
+enum class TVectorOp : std::uint8_t
+{
+	EmplaceBack,
+	Emplace,
+	Erase,
+	PopBack,
+	Clear,
+	// Elements written in place, the payload holds the new values of the elements from DataIndex on
+	Assign,
+	// A call to optimizeLayout(), Generation holds its grace epochs
+	OptimizeLayout
+};
+
+// The whole state of a vector, as sent to a TVectorObserver, the tables are their raw bytes
+struct TVectorState
+{
+	std::uint64_t	mSize;
+	std::uint64_t	mDefaultID;
+	std::uint64_t	mLayoutBaseID;
+
+	// Modifications left before the forwarding table of optimizeLayout() expires
+	std::uint64_t	mForwardingGrace;
+
+	const void*		mAtoms;
+	std::size_t		mAtomsBytes;
+	const void*		mMarks;
+	std::size_t		mMarksBytes;
+	const void*		mForwarding;
+	std::size_t		mForwardingBytes;
+	const void*		mData;
+	std::size_t		mDataBytes;
+};
+
+// Receives the mutations of the vectors it's attached to, with enough information to repeat them on another vector
+// Inserting, erasing, clearing and optimizeLayout() are reported as they happen. The elements written in place through operator[], at(),
+// front(), back(), data() or a mutable iterator are reported as Assign records by TVector::publishWrites(), see there
+// The payload is the raw bytes of the elements, so observers can only be attached to vectors of trivially copyable types
+class TVectorObserver
+{
+public:
+
+	virtual ~TVectorObserver() = default;
+
+	// A single mutation, DataIndex/MarkPos/Generation describe the (first) element it affected
+	virtual void onMutation(TVectorOp Op, std::uint64_t DataIndex, std::uint64_t MarkPos, std::uint64_t Generation, const void* Payload, std::size_t PayloadSize) = 0;
+
+	// The whole state of the vector, sent when the observer is attached and when the vector contents are replaced
+	virtual void onState(const TVectorState& State) = 0;
+};
+
+// Tells whether a type can be moved to a new address with a plain memory copy
+// Specialize it as std::true_type for types that don't hold pointers to themselves
+template <class Type>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Type>
+{
+};
+
+// Moves objects between uninitialized storage, the source objects are left destroyed
+template <class Type>
+struct TRelocator
+{
+	// Relocation that can't throw, so shifting an array never leaves a hole in it
+	static constexpr bool IsNoexcept = IsTriviallyRelocatable<Type>::value || std::is_nothrow_move_constructible<Type>::value;
+
+	// Relocate objects to a storage that doesn't overlap the source, the source is untouched if a copy throws
+	static void relocate(void* Destination, void* Source, std::size_t Count)
+	{
+		auto DestinationObjects = static_cast<Type*>(Destination);
+		auto SourceObjects = static_cast<Type*>(Source);
+
+		// Bulk copy the bytes
+		if (IsTriviallyRelocatable<Type>::value)
+		{
+			if (Count)
+				std::memcpy(Destination, Source, Count * sizeof(Type));
+			return;
+		}
+
+		// Move (or copy if the move may throw) every object, undoing the work if one of them throws
+		auto Index = std::size_t(0);
+		try
+		{
+			for (; Index < Count; ++Index)
+				new(DestinationObjects + Index) Type(std::move_if_noexcept(SourceObjects[Index]));
+		}
+		catch (...)
+		{
+			while (Index > 0)
+				DestinationObjects[--Index].~Type();
+
+			throw;
+		}
+
+		// Destroy the source objects
+		for (Index = 0; Index < Count; ++Index)
+			SourceObjects[Index].~Type();
+	}
+
+	// Relocate objects to a lower address, the storage may overlap
+	static void relocateLeft(void* Destination, void* Source, std::size_t Count) noexcept(IsNoexcept)
+	{
+		auto DestinationObjects = static_cast<Type*>(Destination);
+		auto SourceObjects = static_cast<Type*>(Source);
+
+		// Bulk move the bytes
+		if (IsTriviallyRelocatable<Type>::value)
+		{
+			if (Count)
+				std::memmove(Destination, Source, Count * sizeof(Type));
+			return;
+		}
+
+		// Single forward pass, each object is moved then destroyed
+		for (auto Index = std::size_t(0); Index < Count; ++Index)
+		{
+			new(DestinationObjects + Index) Type(std::move(SourceObjects[Index]));
+			SourceObjects[Index].~Type();
+		}
+	}
+
+	// Relocate objects to a higher address, the storage may overlap
+	static void relocateRight(void* Destination, void* Source, std::size_t Count) noexcept(IsNoexcept)
+	{
+		auto DestinationObjects = static_cast<Type*>(Destination);
+		auto SourceObjects = static_cast<Type*>(Source);
+
+		// Bulk move the bytes
+		if (IsTriviallyRelocatable<Type>::value)
+		{
+			if (Count)
+				std::memmove(Destination, Source, Count * sizeof(Type));
+			return;
+		}
+
+		// Single backward pass, each object is moved then destroyed
+		for (auto Index = Count; Index > 0; --Index)
+		{
+			new(DestinationObjects + Index - 1) Type(std::move(SourceObjects[Index - 1]));
+			SourceObjects[Index - 1].~Type();
+		}
+	}
+};
+
+// Runs Task(Index) for every Index below Count, possibly in parallel, and returns when all of them are done
+// The tasks given by the vectors never throw
+using TVectorExecutor = std::function<void(std::size_t Count, const std::function<void(std::size_t)>& Task)>;
+
+// Small pool of worker threads, the default executor of the parallel relocations
+class TVectorThreadPool
+{
+public:
+
+	// Start the workers, the thread calling run() works too
+	explicit TVectorThreadPool(unsigned int Workers = defaultWorkers()) :
+		mTask(nullptr),
+		mCount(0u),
+		mNext(0u),
+		mActive(0u),
+		mGeneration(0u),
+		mStop(false)
+	{
+		for (auto Index = 0u; Index < Workers; ++Index)
+			mWorkers.emplace_back(&TVectorThreadPool::work, this);
+	}
+
+	TVectorThreadPool(const TVectorThreadPool& Copy) = delete;
+	TVectorThreadPool& operator=(const TVectorThreadPool& Copy) = delete;
+
+	~TVectorThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			mStop = true;
+		}
+		mWake.notify_all();
+
+		for (auto& Worker : mWorkers)
+			Worker.join();
+	}
+
+	// Calls Task(Index) for every Index below Count across the workers, returns when all of them are done
+	void run(std::size_t Count, const std::function<void(std::size_t)>& Task)
+	{
+		// One job at a time
+		std::lock_guard<std::mutex> RunLock(mRunMutex);
+
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			mTask = &Task;
+			mCount = Count;
+			mNext.store(0u);
+			++mGeneration;
+		}
+		mWake.notify_all();
+
+		runTasks(Task, Count);
+
+		// Every index is taken, wait for the workers still running one
+		std::unique_lock<std::mutex> Lock(mMutex);
+		mTask = nullptr;
+		mDone.wait(Lock, [this] { return mActive == 0u; });
+	}
+
+	// The pool shared by all the vectors, started on first use
+	static TVectorThreadPool& shared()
+	{
+		static TVectorThreadPool Pool;
+		return Pool;
+	}
+
+	// One worker less than the hardware threads, a few threads are enough to saturate the memory bandwidth
+	static unsigned int defaultWorkers()
+	{
+		auto Threads = std::thread::hardware_concurrency();
+		return Threads > 1u ? std::min(Threads - 1u, 15u) : 1u;
+	}
+
+private:
+
+	// Worker thread, join every job until the pool is destroyed
+	void work()
+	{
+		auto Generation = std::uint64_t(0);
+		for (;;)
+		{
+			const std::function<void(std::size_t)>* Task;
+			std::size_t Count;
+			{
+				std::unique_lock<std::mutex> Lock(mMutex);
+				mWake.wait(Lock, [this, Generation] { return mStop || (mTask && mGeneration != Generation); });
+				if (mStop)
+					return;
+
+				Generation = mGeneration;
+				Task = mTask;
+				Count = mCount;
+				++mActive;
+			}
+
+			runTasks(*Task, Count);
+
+			{
+				std::lock_guard<std::mutex> Lock(mMutex);
+				--mActive;
+			}
+			mDone.notify_one();
+		}
+	}
+
+	// Take indices until there are none left
+	void runTasks(const std::function<void(std::size_t)>& Task, std::size_t Count)
+	{
+		for (auto Index = mNext.fetch_add(1u); Index < Count; Index = mNext.fetch_add(1u))
+			Task(Index);
+	}
+
+private:
+	std::vector<std::thread>	mWorkers;
+	std::mutex					mRunMutex;
+	std::mutex					mMutex;
+	std::condition_variable		mWake;
+	std::condition_variable		mDone;
+
+	// Current job
+	const std::function<void(std::size_t)>*	mTask;
+	std::size_t								mCount;
+	std::atomic<std::size_t>				mNext;
+	std::size_t								mActive;
+	std::uint64_t							mGeneration;
+	bool									mStop;
+};
+
+// Destinations bigger than this are written with non-temporal stores, about the size of a last level cache
+static constexpr std::size_t TVectorStreamingBytes = std::size_t(32) << 20;
+
+// How a vector splits its big relocations, see TVector::setParallelRelocation
+struct TParallelRelocation
+{
+	std::size_t		mThresholdBytes;
+	std::size_t		mStreamingBytes;
+	TVectorExecutor	mExecutor;
+};
+
+// Bytes held by a vector, see TVector::memoryUsage
+struct TVectorMemoryUsage
+{
+	// The elements
+	std::size_t	mPayloadBytes;
+
+	// The atoms in use, the end() one included
+	std::size_t	mAtomBytes;
+
+	// The marks, the ones of the erased elements included, and the forwarding table of optimizeLayout()
+	std::size_t	mMarkBytes;
+
+	// Allocated but unused: the spare capacity of every table and the old array of a migration
+	std::size_t	mSlackBytes;
+
+	std::size_t total() const noexcept
+	{
+		return mPayloadBytes + mAtomBytes + mMarkBytes + mSlackBytes;
+	}
+};
+
+// The parts of a data array written since they were last consumed, one bit per page of 2^PageShift elements
+// See TVector::setDirtyTracking
+class TVectorDirtyPages
+{
+public:
+
+	// Largest power of two number of elements that fits a 4KB page
+	static constexpr unsigned int pageShift(std::size_t ElementBytes)
+	{
+		unsigned int Shift = 0u;
+		while ((std::size_t(2) << Shift) * ElementBytes <= 4096u)
+			++Shift;
+
+		return Shift;
+	}
+
+	explicit TVectorDirtyPages(unsigned int PageShift) :
+		mPageShift(PageShift),
+		mAll(false)
+	{
+	}
+
+	// Mark the pages of the elements [First, Last) as dirty
+	void mark(std::size_t First, std::size_t Last)
+	{
+		if (First >= Last || mAll)
+			return;
+
+		auto FirstPage = First >> mPageShift;
+		auto LastPage = (Last - 1) >> mPageShift;
+		if ((LastPage >> 6) >= mBits.size())
+			mBits.resize((LastPage >> 6) + 1u, 0u);
+
+		// Set the bits a word at a time
+		for (auto Word = FirstPage >> 6; Word <= LastPage >> 6; ++Word)
+		{
+			auto Low = Word == FirstPage >> 6 ? FirstPage & 63u : 0u;
+			auto High = Word == LastPage >> 6 ? LastPage & 63u : 63u;
+			mBits[Word] |= (~std::uint64_t(0) >> (63u - High)) & (~std::uint64_t(0) << Low);
+		}
+	}
+
+	// Mark everything as dirty, without allocating
+	void markAll() noexcept
+	{
+		mAll = true;
+	}
+
+	// Calls Function(First, Last) for every range of dirty elements below Size, consecutive dirty pages make one range
+	// Everything is clean afterwards, unless Function throws
+	template <class TFunction>
+	void consume(std::size_t Size, TFunction&& Function)
+	{
+		if (mAll)
+		{
+			if (Size)
+				Function(std::size_t(0), Size);
+		}
+		else
+		{
+			// Current run of pages [RunFirst, RunLast)
+			auto PageCount = (Size + (std::size_t(1) << mPageShift) - 1u) >> mPageShift;
+			auto RunFirst = std::size_t(0);
+			auto RunLast = std::size_t(0);
+			for (auto Word = std::size_t(0); Word < mBits.size() && (Word << 6) < PageCount; ++Word)
+				for (auto Bits = mBits[Word]; Bits; Bits &= Bits - 1u)
+				{
+					auto Page = (Word << 6) + lowestBit(Bits);
+					if (Page >= PageCount)
+						break;
+
+					if (Page != RunLast || RunFirst == RunLast)
+					{
+						if (RunFirst != RunLast)
+							Function(RunFirst << mPageShift, RunLast << mPageShift);
+						RunFirst = Page;
+					}
+					RunLast = Page + 1u;
+				}
+
+			// The last page is cut at the end of the vector
+			if (RunFirst != RunLast)
+				Function(RunFirst << mPageShift, std::min(RunLast << mPageShift, Size));
+		}
+
+		std::fill(mBits.begin(), mBits.end(), std::uint64_t(0));
+		mAll = false;
+	}
+
+private:
+
+	static unsigned int lowestBit(std::uint64_t Bits)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long Bit;
+		_BitScanForward64(&Bit, Bits);
+		return static_cast<unsigned int>(Bit);
+#elif defined(__GNUC__)
+		return static_cast<unsigned int>(__builtin_ctzll(Bits));
+#else
+		auto Bit = 0u;
+		for (; !(Bits & 1u); Bits >>= 1)
+			++Bit;
+		return Bit;
+#endif
+	}
+
+private:
+	std::vector<std::uint64_t>	mBits;
+	unsigned int				mPageShift;
+
+	// Everything is dirty, set by the changes that rewrite the whole vector
+	bool						mAll;
+};
+
+// Relocations split across the threads of an executor once they move enough bytes
+// Only types relocatable without throwing are split, and overlapping shifts only for trivially relocatable types
 template <class Type>
+struct TParallelRelocator
+{
+	// Limits on how a relocation is split
+	static constexpr std::size_t MinTaskBytes = std::size_t(256) << 10;
+	static constexpr std::size_t MaxTasks = 64u;
+
+	// Relocate objects to a storage that doesn't overlap the source
+	static void relocate(void* Destination, void* Source, std::size_t Count, const TParallelRelocation* Policy)
+	{
+		auto Output = static_cast<Type*>(Destination);
+		auto Input = static_cast<Type*>(Source);
+		auto Streaming = IsTriviallyRelocatable<Type>::value && Policy && Count * sizeof(Type) >= Policy->mStreamingBytes;
+
+		// Relocations that can throw stay serial, so a failure can be undone
+		auto Tasks = taskCount(Count, Policy);
+		if (Tasks < 2 || !TRelocator<Type>::IsNoexcept)
+		{
+			relocateDisjoint(Output, Input, Count, Streaming);
+			return;
+		}
+
+		Policy->mExecutor(Tasks, [=](std::size_t Task)
+		{
+			auto First = Count * Task / Tasks;
+			auto Last = Count * (Task + 1) / Tasks;
+			relocateDisjoint(Output + First, Input + First, Last - First, Streaming);
+		});
+	}
+
+	// Relocate objects to a higher address, the storage may overlap
+	static void relocateRight(void* Destination, void* Source, std::size_t Count, const TParallelRelocation* Policy) noexcept(TRelocator<Type>::IsNoexcept)
+	{
+		auto Output = static_cast<Type*>(Destination);
+		auto Input = static_cast<Type*>(Source);
+		auto Distance = static_cast<std::size_t>(Output - Input);
+
+		auto Tasks = overlappingTaskCount(Count, Distance, Policy);
+		if (Tasks < 2)
+		{
+			TRelocator<Type>::relocateRight(Destination, Source, Count);
+			return;
+		}
+
+		// Every piece but the first saves its first Distance elements, the piece before it overwrites them
+		auto SavedBytes = Distance * sizeof(Type);
+		std::unique_ptr<unsigned char[]> Saved(new(std::nothrow) unsigned char[SavedBytes * (Tasks - 1)]);
+		if (!Saved)
+		{
+			TRelocator<Type>::relocateRight(Destination, Source, Count);
+			return;
+		}
+
+		for (auto Task = std::size_t(1); Task < Tasks; ++Task)
+			std::memcpy(Saved.get() + SavedBytes * (Task - 1), Input + Count * Task / Tasks, SavedBytes);
+
+		// Each piece moves the rest of itself, then puts back its saved elements
+		auto SavedData = Saved.get();
+		Policy->mExecutor(Tasks, [=](std::size_t Task)
+		{
+			auto First = Count * Task / Tasks;
+			auto Last = Count * (Task + 1) / Tasks;
+			if (!Task)
+			{
+				std::memmove(static_cast<void*>(Output + First), Input + First, (Last - First) * sizeof(Type));
+				return;
+			}
+
+			std::memmove(static_cast<void*>(Output + First + Distance), Input + First + Distance, (Last - First - Distance) * sizeof(Type));
+			std::memcpy(static_cast<void*>(Output + First), SavedData + SavedBytes * (Task - 1), SavedBytes);
+		});
+	}
+
+	// Relocate objects to a lower address, the storage may overlap
+	static void relocateLeft(void* Destination, void* Source, std::size_t Count, const TParallelRelocation* Policy) noexcept(TRelocator<Type>::IsNoexcept)
+	{
+		auto Output = static_cast<Type*>(Destination);
+		auto Input = static_cast<Type*>(Source);
+		auto Distance = static_cast<std::size_t>(Input - Output);
+
+		auto Tasks = overlappingTaskCount(Count, Distance, Policy);
+		if (Tasks < 2)
+		{
+			TRelocator<Type>::relocateLeft(Destination, Source, Count);
+			return;
+		}
+
+		// Every piece but the last saves its last Distance elements, the piece after it overwrites them
+		auto SavedBytes = Distance * sizeof(Type);
+		std::unique_ptr<unsigned char[]> Saved(new(std::nothrow) unsigned char[SavedBytes * (Tasks - 1)]);
+		if (!Saved)
+		{
+			TRelocator<Type>::relocateLeft(Destination, Source, Count);
+			return;
+		}
+
+		for (auto Task = std::size_t(0); Task + 1 < Tasks; ++Task)
+			std::memcpy(Saved.get() + SavedBytes * Task, Input + Count * (Task + 1) / Tasks - Distance, SavedBytes);
+
+		// Each piece moves the rest of itself, then puts back its saved elements
+		auto SavedData = Saved.get();
+		Policy->mExecutor(Tasks, [=](std::size_t Task)
+		{
+			auto First = Count * Task / Tasks;
+			auto Last = Count * (Task + 1) / Tasks;
+			if (Task + 1 == Tasks)
+			{
+				std::memmove(static_cast<void*>(Output + First), Input + First, (Last - First) * sizeof(Type));
+				return;
+			}
+
+			std::memmove(static_cast<void*>(Output + First), Input + First, (Last - First - Distance) * sizeof(Type));
+			std::memcpy(static_cast<void*>(Output + Last - Distance), SavedData + SavedBytes * Task, SavedBytes);
+		});
+	}
+
+private:
+
+	// Number of pieces a relocation is split in, 1 if it stays serial
+	static std::size_t taskCount(std::size_t Count, const TParallelRelocation* Policy)
+	{
+		auto Bytes = Count * sizeof(Type);
+		if (!Policy || !Policy->mThresholdBytes || Bytes < Policy->mThresholdBytes)
+			return 1u;
+
+		return std::min(std::size_t(MaxTasks), std::max(std::size_t(2), Bytes / MinTaskBytes));
+	}
+
+	// Number of pieces of a shift, each one must be at least as long as the shift distance
+	static std::size_t overlappingTaskCount(std::size_t Count, std::size_t Distance, const TParallelRelocation* Policy)
+	{
+		if (!IsTriviallyRelocatable<Type>::value || !Distance || Distance >= Count)
+			return 1u;
+
+		return std::min(taskCount(Count, Policy), Count / Distance);
+	}
+
+	// Serial relocation of a piece, trivially relocatable types can be streamed
+	static void relocateDisjoint(Type* Destination, Type* Source, std::size_t Count, bool Streaming)
+	{
+		if (Streaming)
+			streamCopy(Destination, Source, Count * sizeof(Type));
+		else
+			TRelocator<Type>::relocate(Destination, Source, Count);
+	}
+
+	// Copy bytes with non-temporal stores, so a destination bigger than the cache doesn't evict everything else
+	static void streamCopy(void* Destination, const void* Source, std::size_t Bytes)
+	{
+#ifdef TVECTOR_SSE2
+		auto Output = static_cast<unsigned char*>(Destination);
+		auto Input = static_cast<const unsigned char*>(Source);
+
+		// Copy normally up to the first 16 byte boundary of the destination
+		auto Head = std::min<std::size_t>((16u - reinterpret_cast<std::uintptr_t>(Output) % 16u) % 16u, Bytes);
+		std::memcpy(Output, Input, Head);
+		Output += Head;
+		Input += Head;
+		Bytes -= Head;
+
+		// Stream 64 bytes at a time
+		for (; Bytes >= 64u; Output += 64, Input += 64, Bytes -= 64u)
+		{
+			auto Block0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input));
+			auto Block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 16));
+			auto Block2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 32));
+			auto Block3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(Output), Block0);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(Output + 16), Block1);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(Output + 32), Block2);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(Output + 48), Block3);
+		}
+
+		// The streaming stores must be visible before the memory is used
+		_mm_sfence();
+		std::memcpy(Output, Input, Bytes);
+#else
+		std::memcpy(Destination, Source, Bytes);
+#endif
+	}
+};
+
+// Position is the unsigned type of the indices and sizes, ID the unsigned type of the iterator generations
+// The Atom/Mark/Iterator layouts follow them, 16 bit keeps small tables cache dense while 64 bit allows huge ones
+template <class Type, class TPosition = unsigned int, class TID = std::uint32_t>
 class TVector
 {
+	static_assert(std::is_integral<TPosition>::value && std::is_unsigned<TPosition>::value, "The position type must be an unsigned integer");
+	static_assert(std::is_integral<TID>::value && std::is_unsigned<TID>::value, "The ID type must be an unsigned integer");
 
 private:
 
 	struct Atom;
 	struct Mark;
-	struct Iterator;
 
 public:
 
+	template <bool TConstness>
+	struct TIterator;
+
 	// Type aliases
 	using Data = std::aligned_storage_t<sizeof(Type), alignof(Type)>;
 	using Reference = Type&;
 	using CReference = const Type&;
 	using Pointer = Type*;
-	using Position = unsigned int;
-	using Size = unsigned int;
-	using CIterator = const Iterator;
+	using CPointer = const Type*;
+	using Position = TPosition;
+	using Size = TPosition;
+	using Iterator = TIterator<false>;
+	using CIterator = TIterator<true>;
 
 private:
 
@@ -59,18 +690,9 @@ private:
 			mDataPos(-1)
 		{
 		}
-		Atom(const Atom& Copy) :
-			mMarkPos(Copy.mMarkPos),
-			mDataPos(Copy.mDataPos)
-		{
-		}
-		Atom(Atom&& Move) :
-			mMarkPos(Move.mMarkPos),
-			mDataPos(Move.mDataPos)
-		{
-			Move.mMarkPos = -1;
-			Move.mDataPos = -1;
-		}
+		// Copy/Move are defaulted so the atom is trivially copyable and the atoms vector can be copied in bulk
+		Atom(const Atom& Copy) = default;
+		Atom(Atom&& Move) = default;
 
 		// Construct a mark with a specified Data Position and Mark Position
 		Atom(const Position& DataPos, const Position& MarkPos) :
@@ -80,23 +702,8 @@ private:
 		}
 
 		// Assignment operator
-		Atom& operator=(const Atom& Copy)
-		{
-			mMarkPos = Copy.mMarkPos;
-			mDataPos = Copy.mDataPos;
-
-			return *this;
-		}
-		Atom& operator=(Atom&& Move)
-		{
-			mMarkPos = Move.mMarkPos;
-			mDataPos = Move.mDataPos;
-
-			Move.mMarkPos = -1;
-			Move.mDataPos = -1;
-
-			return *this;
-		}
+		Atom& operator=(const Atom& Copy) = default;
+		Atom& operator=(Atom&& Move) = default;
 
 		Position mDataPos;
 		Position mMarkPos;
@@ -105,8 +712,8 @@ private:
 	// The "Mark" creates a link between the iterator and the atom
 	struct Mark
 	{
-		// Alias for the position using an unsigned short int (16bit)
-		using ID = std::uint32_t;
+		// Alias for the iterator generation
+		using ID = TID;
 
 		// Constructors
 		Mark() :
@@ -114,18 +721,9 @@ private:
 			mIteratorID(-1)
 		{
 		}
-		Mark(const Mark& Copy) :
-			mAtomPos(Copy.mAtomPos),
-			mIteratorID(Copy.mIteratorID)
-		{
-		}
-		Mark(Mark&& Move) :
-			mAtomPos(Move.mAtomPos),
-			mIteratorID(Move.mIteratorID)
-		{
-			Move.mAtomPos = -1;
-			Move.mIteratorID = -1;
-		}
+		// Copy/Move are defaulted so the mark is trivially copyable and the marks vector can be copied in bulk
+		Mark(const Mark& Copy) = default;
+		Mark(Mark&& Move) = default;
 
 		// Construct a mark with a specified Atom Position and Iter ID
 		Mark(const Position& AtomPos, const ID& IterID) :
@@ -135,35 +733,32 @@ private:
 		}
 
 		// Assignment operator
-		Mark& operator=(const Mark& Copy)
-		{
-			mIteratorID = Copy.mIteratorID;
-			mAtomPos = Copy.mAtomPos;
-
-			return *this;
-		}
-		Mark& operator=(Mark&& Move)
-		{
-			mIteratorID = Move.mIteratorID;
-			mAtomPos = Move.mAtomPos;
-
-			Move.mIteratorID = -1;
-			Move.mAtomPos = -1;
-
-			return *this;
-		}
+		Mark& operator=(const Mark& Copy) = default;
+		Mark& operator=(Mark&& Move) = default;
 
 		ID			mIteratorID;
 		Position	mAtomPos;
 	};
 
+public:
+
 	// The "Iterator" keep track of data in the array
-	struct Iterator
+	// Define TVECTOR_CACHED_ITERATORS to let iterators remember the last resolved data position until the vector is modified
+	// Const iterators (CIterator) read the elements without preserving them for the snapshots or marking them dirty
+	template <bool TConstness>
+	struct TIterator
 	{
 		// Alias for an ID
-		using ID = std::uint32_t;
+		using ID = TID;
+
+		// Standard iterator traits
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = Type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<TConstness, CPointer, Pointer>;
+		using reference = std::conditional_t<TConstness, CReference, Reference>;
 
-		Iterator() :
+		TIterator() :
 			mParentVector(nullptr),
 			mMarkPos(-1),
 			mIteratorID(-1)
@@ -171,18 +766,24 @@ private:
 		}
 
 		// Copy constructor
-		Iterator(const Iterator& Copy) :
-			mParentVector(Copy.mParentVector),
+		TIterator(const TIterator& Copy) = default;
+
+		// A mutable iterator converts to a const one
+		template <bool TOtherConstness, class = std::enable_if_t<TConstness && !TOtherConstness>>
+		TIterator(const TIterator<TOtherConstness>& Copy) :
+			mIteratorID(Copy.mIteratorID),
 			mMarkPos(Copy.mMarkPos),
-			mIteratorID(Copy.mIteratorID)
+			mParentVector(Copy.mParentVector)
 		{
+#ifdef TVECTOR_CACHED_ITERATORS
+			mCachedIndex = Copy.mCachedIndex;
+			mCachedEpoch = Copy.mCachedEpoch;
+#endif
 		}
 
 		// Move constructor
-		Iterator(Iterator&& Move) :
-			mParentVector(Move.mParentVector),
-			mMarkPos(Move.mMarkPos),
-			mIteratorID(Move.mIteratorID)
+		TIterator(TIterator&& Move) :
+			TIterator(static_cast<const TIterator&>(Move))
 		{
 			Move.mParentVector = nullptr;
 			Move.mMarkPos = -1;
@@ -190,15 +791,21 @@ private:
 		}
 
 		// Create an iterator starting from the data position
-		Iterator(const Position& DataPosition, const TVector* ParentVector)
+		TIterator(const Position& DataPosition, const TVector* ParentVector)
 		{
 			// If we are creating an end() Iterator
 			mMarkPos = ParentVector->mAtomsVector[DataPosition].mMarkPos;
 			mIteratorID = ParentVector->mMarksVector[mMarkPos].mIteratorID;
 			mParentVector = ParentVector;
+
+#ifdef TVECTOR_CACHED_ITERATORS
+			// We already know where the data is
+			mCachedIndex = DataPosition;
+			mCachedEpoch = ParentVector->mEpoch;
+#endif
 		}
 
-		Iterator(const Position& MarkPos, const ID& IteratorID, const TVector* ParentVector) :
+		TIterator(const Position& MarkPos, const ID& IteratorID, const TVector* ParentVector) :
 			mParentVector(ParentVector),
 			mMarkPos(MarkPos),
 			mIteratorID(IteratorID)
@@ -207,21 +814,12 @@ private:
 
 #pragma region Assignemt operators
 		// Copy assignment
-		Iterator& operator =(const Iterator& Copy)
-		{
-			mParentVector = Copy.mParentVector;
-			mMarkPos = Copy.mMarkPos;
-			mIteratorID = Copy.mIteratorID;
-
-			return *this;
-		}
+		TIterator& operator =(const TIterator& Copy) = default;
 
 		// Move assignment
-		Iterator& operator =(Iterator&& Move)
+		TIterator& operator =(TIterator&& Move)
 		{
-			mParentVector = Move.mParentVector;
-			mMarkPos = Move.mMarkPos;
-			mIteratorID = Move.mIteratorID;
+			*this = static_cast<const TIterator&>(Move);
 
 			Move.mParentVector = nullptr;
 			Move.mMarkPos = -1;
@@ -231,7 +829,7 @@ private:
 		}
 
 		// Addition assignment
-		Iterator& operator +=(const Position& Offset)
+		TIterator& operator +=(const difference_type& Offset)
 		{
 			*this = *this + Offset;
 
@@ -239,7 +837,7 @@ private:
 		}
 
 		// Subtraction assignment
-		Iterator& operator -=(const Position& Offset)
+		TIterator& operator -=(const difference_type& Offset)
 		{
 			*this = *this - Offset;
 
@@ -249,48 +847,54 @@ private:
 
 #pragma region Member Access
 		// Indirection 
-		Reference operator*()
+		reference operator*() const
 		{
 			// Check if this iterator points to valid Data
 			assert(isValid());
 
-			return mParentVector->referenceCast(mParentVector->mVectorData[mParentVector->getDataIndexFromIterator(*this)]);
+			return access(getIndex(), std::integral_constant<bool, TConstness>());
 		}
 
 		// Address-of 
-		Pointer operator&()
+		pointer operator&() const
 		{
 			return &(operator*());
 		}
 
 		// Member of pointer 
-		Pointer operator->()
+		pointer operator->() const
 		{
 			return operator&();
 		}
+
+		// Subscript
+		reference operator[](const difference_type& Offset) const
+		{
+			return access(static_cast<Position>(getIndex() + Offset), std::integral_constant<bool, TConstness>());
+		}
 #pragma endregion
 
 #pragma region Arithmetic operators
 		// Pre-increment/Pre-decrement
-		Iterator& operator++()
+		TIterator& operator++()
 		{
 			*this = *this + 1;
 			return *this;
 		}
-		Iterator& operator--()
+		TIterator& operator--()
 		{
 			*this = *this - 1;
 			return *this;
 		}
 
 		// Post-increment/Post-decrement
-		Iterator operator++(int)
+		TIterator operator++(int)
 		{
 			auto Temp = *this;
 			*this = *this + 1;
 			return Temp;
 		}
-		Iterator operator--(int)
+		TIterator operator--(int)
 		{
 			auto Temp = *this;
 			*this = *this - 1;
@@ -298,66 +902,481 @@ private:
 		}
 
 		// Addition	operator
-		Iterator operator+(const Position& Offset)
+		TIterator operator+(const difference_type& Offset) const
 		{
-			return Iterator(mParentVector->getDataIndexFromIterator(*this) + Offset, mParentVector);
+			return TIterator(static_cast<Position>(getIndex() + Offset), mParentVector);
+		}
+		friend TIterator operator+(const difference_type& Offset, const TIterator& Right)
+		{
+			return Right + Offset;
 		}
 
 		// Subtraction	operator
-		Iterator operator-(const Position& Offset)
+		TIterator operator-(const difference_type& Offset) const
 		{
-			return Iterator(mParentVector->getDataIndexFromIterator(*this) - Offset, mParentVector);
+			return TIterator(static_cast<Position>(getIndex() - Offset), mParentVector);
 		}
-#pragma endregion
 
-#pragma region Comparison operators
-		bool operator ==(const Iterator& Right) const
+		// Distance between two iterators
+		template <bool TOtherConstness>
+		difference_type operator-(const TIterator<TOtherConstness>& Right) const
 		{
-			return mParentVector->getDataIndexFromIterator(*this) == mParentVector->getDataIndexFromIterator(Right);
+			return static_cast<difference_type>(getIndex()) - static_cast<difference_type>(Right.getIndex());
 		}
-		bool operator !=(const Iterator& Right) const
+#pragma endregion
+
+#pragma region Comparison operators
+		template <bool TOtherConstness>
+		bool operator ==(const TIterator<TOtherConstness>& Right) const
+		{
+			return getIndex() == Right.getIndex();
+		}
+		template <bool TOtherConstness>
+		bool operator !=(const TIterator<TOtherConstness>& Right) const
 		{
 			return !(*this == Right);
 		}
-		bool operator <(const Iterator& Right) const
+		template <bool TOtherConstness>
+		bool operator <(const TIterator<TOtherConstness>& Right) const
 		{
-			return mParentVector->getDataIndexFromIterator(*this) < mParentVector->getDataIndexFromIterator(Right);
+			return getIndex() < Right.getIndex();
 		}
-		bool operator >(const Iterator& Right) const
+		template <bool TOtherConstness>
+		bool operator >(const TIterator<TOtherConstness>& Right) const
 		{
-			return !(*this < Right);
+			return Right < *this;
 		}
-		bool operator <=(const Iterator& Right) const
+		template <bool TOtherConstness>
+		bool operator <=(const TIterator<TOtherConstness>& Right) const
 		{
-			return mParentVector->getDataIndexFromIterator(*this) <= mParentVector->getDataIndexFromIterator(Right);
+			return !(Right < *this);
 		}
-		bool operator >=(const Iterator& Right) const
+		template <bool TOtherConstness>
+		bool operator >=(const TIterator<TOtherConstness>& Right) const
 		{
-			return mParentVector->getDataIndexFromIterator(*this) >= mParentVector->getDataIndexFromIterator(Right);
+			return !(*this < Right);
 		}
 #pragma endregion
 
 		// Check if the iterator is valid
-		inline bool isValid()
+		inline bool isValid() const
 		{
 			// Check if this iterator ID is the same of the connectred MARK 
-			return mParentVector->mMarksVector[mMarkPos].mIteratorID == mIteratorID;
+			return mParentVector && mParentVector->isIteratorValid(*this);
+		}
+
+		// The position of the connected mark and the ID it had when the iterator was created, together they identify the element
+		// Iterator(MarkPos, ID, ParentVector) builds the iterator back from them
+		const Position& markPos() const noexcept
+		{
+			return mMarkPos;
+		}
+		const ID& id() const noexcept
+		{
+			return mIteratorID;
 		}
 
 	private:
+		template <bool TOtherConstness>
+		friend struct TIterator;
+
+		// Mutable iterators preserve the element for the snapshots and mark it dirty, const ones only read it
+		Reference access(const Position& Index, std::false_type) const
+		{
+			return mParentVector->referenceCast(mParentVector->getWritableData(Index));
+		}
+		CReference access(const Position& Index, std::true_type) const
+		{
+			return mParentVector->referenceCast(mParentVector->getData(Index));
+		}
 
 		// Get the connected data mark
-		const Mark& getMark()
+		const Mark& getMark() const
 		{
 			return mParentVector->mMarksVector[mMarkPos];
 		}
 
+		// Get the position in the data array, walking Mark -> Atom only if the vector changed since the last time
+		inline Position getIndex() const
+		{
+#ifdef TVECTOR_CACHED_ITERATORS
+			if (mCachedEpoch != mParentVector->mEpoch)
+			{
+				mCachedIndex = mParentVector->getDataIndexFromIterator(*this);
+				mCachedEpoch = mParentVector->mEpoch;
+			}
+
+			return mCachedIndex;
+#else
+			return mParentVector->getDataIndexFromIterator(*this);
+#endif
+		}
+
 	private:
 		ID			mIteratorID;
 		Position	mMarkPos;
 
-		friend typename TVector;
+		friend class TVector;
 		const TVector*	mParentVector;
+
+#ifdef TVECTOR_CACHED_ITERATORS
+		mutable Position		mCachedIndex = 0u;
+		mutable std::uint64_t	mCachedEpoch = std::uint64_t(-1);
+#endif
+	};
+
+private:
+
+	// Number of bytes a snapshot copies at once when the live vector is about to change them
+	static constexpr std::size_t SnapshotChunkBytes = 64 * 1024;
+
+	// A table (data, atoms or marks) as seen by a snapshot, each chunk is read from the live vector until it's about to change
+	template <class TElement>
+	struct SnapshotTable
+	{
+		using Storage = std::aligned_storage_t<sizeof(TElement), alignof(TElement)>;
+
+		static constexpr std::size_t ChunkSize = SnapshotChunkBytes / sizeof(TElement) ? SnapshotChunkBytes / sizeof(TElement) : 1u;
+
+		SnapshotTable(const void* Live, std::size_t Count) :
+			mLive(static_cast<const Storage*>(Live)),
+			mCount(Count),
+			mChunkCount((Count + ChunkSize - 1) / ChunkSize),
+			mCopiedChunks(0u),
+			mChunks(new std::atomic<Storage*>[mChunkCount])
+		{
+			for (auto Chunk = std::size_t(0); Chunk < mChunkCount; ++Chunk)
+				mChunks[Chunk].store(nullptr, std::memory_order_relaxed);
+		}
+
+		~SnapshotTable()
+		{
+			for (auto Chunk = std::size_t(0); Chunk < mChunkCount; ++Chunk)
+				delete[] mChunks[Chunk].load(std::memory_order_relaxed);
+		}
+
+		// Copy the chunks overlapping [First, Last) that are still read from the live vector, returns true if it copied any
+		bool preserve(std::size_t First, std::size_t Last)
+		{
+			if (Last > mCount)
+				Last = mCount;
+			if (First >= Last)
+				return false;
+
+			auto Copied = false;
+			for (auto Chunk = First / ChunkSize; Chunk <= (Last - 1) / ChunkSize; ++Chunk)
+			{
+				if (mChunks[Chunk].load(std::memory_order_relaxed))
+					continue;
+
+				auto Begin = Chunk * ChunkSize;
+				auto Count = mCount - Begin < ChunkSize ? mCount - Begin : ChunkSize;
+				auto Copy = new Storage[Count];
+				std::memcpy(Copy, mLive + Begin, Count * sizeof(TElement));
+
+				// Sequentially consistent, so a reader either sees the copy or is counted in the live readers
+				mChunks[Chunk].store(Copy, std::memory_order_seq_cst);
+				++mCopiedChunks;
+				Copied = true;
+			}
+
+			return Copied;
+		}
+
+		// Read an element, from the copy if there is one, else from the live vector while being counted as a live reader
+		TElement read(std::size_t Index, std::atomic<int>& LiveReaders) const
+		{
+			Storage Element;
+
+			auto Chunk = mChunks[Index / ChunkSize].load(std::memory_order_acquire);
+			if (!Chunk)
+			{
+				LiveReaders.fetch_add(1, std::memory_order_seq_cst);
+				Chunk = mChunks[Index / ChunkSize].load(std::memory_order_seq_cst);
+				std::memcpy(&Element, Chunk ? Chunk + Index % ChunkSize : mLive + Index, sizeof(TElement));
+				LiveReaders.fetch_sub(1, std::memory_order_release);
+
+				return reinterpret_cast<const TElement&>(Element);
+			}
+
+			std::memcpy(&Element, Chunk + Index % ChunkSize, sizeof(TElement));
+			return reinterpret_cast<const TElement&>(Element);
+		}
+
+		const Storage*								mLive;
+		std::size_t									mCount;
+		std::size_t									mChunkCount;
+		std::size_t									mCopiedChunks;
+		std::unique_ptr<std::atomic<Storage*>[]>	mChunks;
+	};
+
+	// Everything a snapshot sees, shared with the live vector until all of it has been copied
+	struct SnapshotState
+	{
+		SnapshotState(const TVector& Vector) :
+			mSize(Vector.mVectorSize),
+			mData(Vector.mVectorData, Vector.mVectorSize),
+			mAtoms(Vector.mAtomsVector.data(), Vector.mAtomsVector.size()),
+			mMarks(Vector.mMarksVector.data(), Vector.mMarksVector.size()),
+			mLiveReaders(0)
+		{
+		}
+
+		// Wait for the readers that may be looking at a part of the live vector which is about to change
+		void waitLiveReaders() const
+		{
+			while (mLiveReaders.load(std::memory_order_seq_cst))
+				std::this_thread::yield();
+		}
+
+		// Checks whether every table has been copied, so the live vector can forget about this snapshot
+		bool isDetached() const
+		{
+			return mData.mCopiedChunks == mData.mChunkCount && mAtoms.mCopiedChunks == mAtoms.mChunkCount && mMarks.mCopiedChunks == mMarks.mChunkCount;
+		}
+
+		Size						mSize;
+		SnapshotTable<Type>			mData;
+		SnapshotTable<Atom>			mAtoms;
+		SnapshotTable<Mark>			mMarks;
+		mutable std::atomic<int>	mLiveReaders;
+	};
+
+public:
+
+	// Immutable view of the vector at the time snapshot() was called, it can be read from any thread while the vector changes
+	class Snapshot
+	{
+	public:
+
+		// Returns the number of elements
+		Size size() const noexcept
+		{
+			return mState ? mState->mSize : 0u;
+		}
+
+		// Checks whether the snapshot is empty
+		bool empty() const noexcept
+		{
+			return !size();
+		}
+
+		// Returns a copy of the specified element
+		Type operator[](const Size& Index) const
+		{
+			assert(Index < size());
+
+			return mState->mData.read(Index, mState->mLiveReaders);
+		}
+
+		// Find the element an iterator pointed to when the snapshot was taken, returns false if it wasn't valid
+		bool find(const CIterator& Handle, Type& Element) const
+		{
+			if (!mState || Handle.mMarkPos >= mState->mMarks.mCount)
+				return false;
+
+			auto HandleMark = mState->mMarks.read(Handle.mMarkPos, mState->mLiveReaders);
+			if (HandleMark.mIteratorID != Handle.mIteratorID)
+				return false;
+
+			auto HandleAtom = mState->mAtoms.read(HandleMark.mAtomPos, mState->mLiveReaders);
+			if (HandleAtom.mDataPos >= mState->mSize)
+				return false;
+
+			Element = mState->mData.read(HandleAtom.mDataPos, mState->mLiveReaders);
+			return true;
+		}
+
+	private:
+		friend class TVector;
+		std::shared_ptr<const SnapshotState>	mState;
+	};
+
+private:
+
+	// Where the mark of an iterator went after optimizeLayout(), with the ID the iterator must have to be forwarded
+	struct MarkForward
+	{
+		Position	mMarkPos;
+		TID			mIteratorID;
+	};
+
+	static constexpr Position InvalidPosition = Position(-1);
+	static constexpr TID InvalidID = TID(-1);
+
+public:
+
+	// Returned by optimizeLayout(), updates the iterators created before it
+	class LayoutRemap
+	{
+	public:
+
+		// Returns the iterator to use from now on, or a default constructed one if the element was already erased
+		Iterator operator()(const CIterator& OldIterator) const
+		{
+			auto MarkPos = markPos(OldIterator.mMarkPos);
+			if (MarkPos == InvalidPosition || mForwarding[OldIterator.mMarkPos].mIteratorID != OldIterator.mIteratorID)
+				return Iterator();
+
+			return Iterator(MarkPos, mNewID, mParentVector);
+		}
+
+		// Returns the new position of a mark, or InvalidPosition if no element used it
+		Position markPos(const Position& OldMarkPos) const
+		{
+			return OldMarkPos < mForwarding.size() ? mForwarding[OldMarkPos].mMarkPos : InvalidPosition;
+		}
+
+		// Returns the number of marks before optimizeLayout()
+		Size size() const noexcept
+		{
+			return static_cast<Size>(mForwarding.size());
+		}
+
+		// Checks whether the IDs ran out and started over from 0, the old iterators are then not forwarded during the grace period
+		bool rebased() const noexcept
+		{
+			return mRebased;
+		}
+
+	private:
+		friend class TVector;
+
+		std::vector<MarkForward>	mForwarding;
+		TID							mNewID;
+		bool						mRebased;
+		const TVector*				mParentVector;
+	};
+
+	// Records positional inserts and erasures, commit() applies all of them in a single pass over the data, atoms and marks
+	// Positions refer to the vector as it was when the batch began, the vector must not be modified until the batch is committed
+	class MutationBatch
+	{
+	public:
+
+		MutationBatch(MutationBatch&& Move) noexcept :
+			mParentVector(Move.mParentVector),
+			mEpoch(Move.mEpoch),
+			mFirstMarkPos(Move.mFirstMarkPos),
+			mElements(Move.mElements),
+			mElementCount(Move.mElementCount),
+			mElementCapacity(Move.mElementCapacity),
+			mInserts(std::move(Move.mInserts)),
+			mErased(std::move(Move.mErased))
+		{
+			Move.mElements = nullptr;
+			Move.mElementCount = Move.mElementCapacity = 0u;
+		}
+
+		MutationBatch(const MutationBatch& Copy) = delete;
+		MutationBatch& operator=(const MutationBatch& Copy) = delete;
+
+		// The elements that were not committed are destroyed
+		~MutationBatch()
+		{
+			for (auto Index = Size(0); Index < mElementCount; ++Index)
+				reinterpret_cast<Pointer>(mElements + Index)->~Type();
+
+			delete[] mElements;
+		}
+
+		// Record the construction of an element before InsertPosition, the returned iterator can be used once the batch is committed
+		template <class... TArgs>
+		Iterator emplace(const CIterator& InsertPosition, TArgs&&... Args)
+		{
+			assert(mParentVector->mEpoch == mEpoch && "The vector was modified while the batch was open");
+
+			// Make room for the record first, so a throwing constructor leaves the batch unchanged
+			if (mElementCount == mElementCapacity)
+				growElements();
+			mInserts.reserve(mInserts.size() + 1);
+
+			new(mElements + mElementCount) Type(std::forward<TArgs>(Args)...);
+			mInserts.push_back({ mParentVector->getDataIndexFromIterator(InsertPosition), mElementCount });
+
+			// The mark the element will get, in the order the elements were recorded
+			return Iterator(static_cast<Position>(mFirstMarkPos + mElementCount++), mParentVector->mIteratorDefaultID, mParentVector);
+		}
+
+		// Record the erasure of an element that was in the vector when the batch began
+		void erase(const CIterator& DeletePosition)
+		{
+			assert(mParentVector->mEpoch == mEpoch && "The vector was modified while the batch was open");
+			assert(DeletePosition.isValid() && DeletePosition != mParentVector->end());
+
+			mErased.push_back(mParentVector->getDataIndexFromIterator(DeletePosition));
+		}
+
+		// Returns true if nothing was recorded since the last commit
+		bool empty() const noexcept
+		{
+			return mInserts.empty() && mErased.empty();
+		}
+
+		// Apply all the recorded mutations, the batch can then record new ones on the updated vector
+		void commit()
+		{
+			mParentVector->commitBatch(*this);
+
+			mEpoch = mParentVector->mEpoch;
+			mFirstMarkPos = static_cast<Position>(mParentVector->mMarksVector.size() - 1);
+			mInserts.clear();
+			mErased.clear();
+		}
+
+	private:
+		friend class TVector;
+
+		// A recorded insertion, the data index it goes before and the index of its element in the batch
+		struct Insert
+		{
+			Position	mIndex;
+			Size		mRecord;
+		};
+
+		MutationBatch(TVector* ParentVector) :
+			mParentVector(ParentVector),
+			mEpoch(ParentVector->mEpoch),
+			mFirstMarkPos(static_cast<Position>(ParentVector->mMarksVector.size() - 1)),
+			mElements(nullptr),
+			mElementCount(0u),
+			mElementCapacity(0u)
+		{
+		}
+
+		// Double the storage of the recorded elements
+		void growElements()
+		{
+			auto NewCapacity = mElementCapacity ? static_cast<Size>(mElementCapacity * 2u) : Size(16u);
+			auto NewElements = new Data[NewCapacity];
+
+			try
+			{
+				TRelocator<Type>::relocate(NewElements, mElements, mElementCount);
+			}
+			catch (...)
+			{
+				delete[] NewElements;
+				throw;
+			}
+
+			delete[] mElements;
+			mElements = NewElements;
+			mElementCapacity = NewCapacity;
+		}
+
+	private:
+		TVector*				mParentVector;
+		std::uint64_t			mEpoch;
+		Position				mFirstMarkPos;
+
+		// The elements to insert, in the order they were recorded
+		Data*					mElements;
+		Size					mElementCount;
+		Size					mElementCapacity;
+
+		std::vector<Insert>		mInserts;
+		std::vector<Position>	mErased;
 	};
 
 public:
@@ -367,51 +1386,167 @@ public:
 		mVectorSize(0u),
 		mVectorCapacity(1u),
 		mVectorData(nullptr),
-		mIteratorDefaultID(0)
+		mOldVectorData(nullptr),
+		mMigratedCount(0u),
+		mMigrationEnd(0u),
+		mMigrationBudget(0u),
+		mShrinkDivisor(0u),
+		mIteratorDefaultID(0),
+		mEpoch(0u),
+		mObserver(nullptr),
+		mWrittenFirst(0u),
+		mWrittenLast(0u),
+		mLayoutBaseID(0u),
+		mForwardingEpoch(0u),
+		mForwardingGrace(0u)
 	{
 		init();
 	}
 
+	// Copy constructor
+	TVector(const TVector& Copy) :
+		mVectorSize(Copy.mVectorSize),
+		mVectorCapacity(Copy.mVectorCapacity),
+		mVectorData(nullptr),
+		mOldVectorData(nullptr),
+		mMigratedCount(0u),
+		mMigrationEnd(0u),
+		mMigrationBudget(Copy.mMigrationBudget),
+		mShrinkDivisor(Copy.mShrinkDivisor),
+		mParallelRelocation(Copy.mParallelRelocation),
+		mIteratorDefaultID(Copy.mIteratorDefaultID),
+		mEpoch(0u),
+		mObserver(nullptr),
+		mWrittenFirst(0u),
+		mWrittenLast(0u),
+		mLayoutBaseID(Copy.mLayoutBaseID),
+		mForwardingEpoch(0u),
+		mForwardingGrace(0u),
+		mAtomsVector(Copy.mAtomsVector),
+		mMarksVector(Copy.mMarksVector)
+	{
+		// The data array is allocated once the tables are copied, and owned by NewData until every element is
+		std::unique_ptr<Data[]> NewData(new Data[mVectorCapacity]);
+
+		// Trivially copyable data can be copied in one shot
+		if (std::is_trivially_copyable<Type>::value && !Copy.mOldVectorData)
+		{
+			std::memcpy(NewData.get(), Copy.mVectorData, mVectorSize * sizeof(Data));
+			mVectorData = NewData.release();
+			return;
+		}
+
+		// Copy construct every element, undoing the work if one of the copies throws
+		auto Index = Size(0);
+		try
+		{
+			for (; Index < mVectorSize; ++Index)
+				new(NewData.get() + Index) Type(referenceCast(Copy.getData(Index)));
+		}
+		catch (...)
+		{
+			while (Index > 0)
+				referenceCast(NewData[--Index]).~Type();
+
+			throw;
+		}
+
+		mVectorData = NewData.release();
+	}
+
+	// Move constructor, steals the storage and leaves the moved vector empty and ready to be used again
+	// The empty vector needs its own end() iterator structure, which is allocated before anything is stolen, so the move isn't noexcept
+	// Iterators store their parent vector, so the ones created from the moved vector keep referring to it
+	TVector(TVector&& Move) :
+		TVector()
+	{
+		// Like clear(), the iterators left in the moved vector must not match its new end() mark
+		mIteratorDefaultID = Move.mIteratorDefaultID + 1u;
+		mMarksVector.back().mIteratorID = mIteratorDefaultID;
+
+		swap(Move);
+	}
+
 	// Default destructor
 	~TVector()
 	{
+		// The snapshots can't read from us anymore
+		preserveAll();
+
 		if (mVectorData)
 		{
 			// Call the destructor for all the allocated element
-			for (auto Index = 0u; Index < mVectorSize; ++Index)
-				referenceCast(mVectorData[Index]).~Type();
+			for (auto Index = Size(0); Index < mVectorSize; ++Index)
+				referenceCast(getData(Index)).~Type();
 
 			// Deallocate all the vector memory
 			delete[] mVectorData;
+			delete[] mOldVectorData;
 			mVectorData = nullptr;
+			mOldVectorData = nullptr;
 		}
 	}
 
+	// Copy assignment
+	TVector& operator=(const TVector& Copy)
+	{
+		// Copy and swap, so a throwing copy leaves this vector untouched
+		TVector Temp(Copy);
+		swap(Temp);
+
+		return *this;
+	}
+
+	// Move assignment, it may throw like the move constructor
+	TVector& operator=(TVector&& Move)
+	{
+		// Steal the moved vector storage, our old storage is released by Temp
+		TVector Temp(std::move(Move));
+		swap(Temp);
+
+		return *this;
+	}
+
 #pragma region Element access 
 
 	// Access the first element
 	Reference  front()
 	{
-		return referenceCast(mVectorData[0]);
+		return referenceCast(getWritableData(0));
 	}
 	CReference front() const
 	{
-		return referenceCast(mVectorData[0]);
+		return referenceCast(getData(0));
 	}
 
 	// Access the last element
 	Reference  back()
 	{
-		return referenceCast(mVectorData[mVectorSize - 1]);
+		return referenceCast(getWritableData(mVectorSize - 1));
 	}
 	CReference back() const
 	{
-		return referenceCast(mVectorData[mVectorSize - 1]);
+		return referenceCast(getData(mVectorSize - 1));
 	}
 
 	// Direct access to the underlying array 
 	Pointer data()
 	{
+		// The underlying array is only contiguous once any pending migration is over
+		finishMigration();
+
+		// Every element may be written through the pointer
+		preserveData(0u, mVectorSize);
+		markDirty(0u, mVectorSize);
+		recordWrite(0u, mVectorSize);
+
+		return pointerCast(mVectorData);
+	}
+	CPointer data() const
+	{
+		// A const vector can't complete the migration by itself
+		assert(!isMigrating());
+
 		return pointerCast(mVectorData);
 	}
 
@@ -421,24 +1556,24 @@ public:
 		// Bound checking
 		assert(Index < mVectorSize);
 
-		return referenceCast(mVectorData[Index]);
+		return referenceCast(getWritableData(Index));
 	}
 	CReference at(const Size& Index) const
 	{
 		// Bound checking
 		assert(Index < mVectorSize);
 
-		return referenceCast(mVectorData[Index]);
+		return referenceCast(getData(Index));
 	}
 
 	// Access specified element
 	Reference  operator[](const Size& Index)
 	{
-		return referenceCast(mVectorData[Index]);
+		return referenceCast(getWritableData(Index));
 	}
 	CReference operator[](const Size& Index) const
 	{
-		return referenceCast(mVectorData[Index]);
+		return referenceCast(getData(Index));
 	}
 
 #pragma endregion
@@ -448,7 +1583,7 @@ public:
 	// Return the iterator to the first element in the vector
 	Iterator begin()
 	{
-		return CIterator(0, this);
+		return Iterator(0, this);
 	}
 	CIterator begin() const
 	{
@@ -462,7 +1597,7 @@ public:
 	// Return the iterator to the past end element in the vector
 	Iterator end()
 	{
-		return CIterator(mVectorSize, this);
+		return Iterator(mVectorSize, this);
 	}
 	CIterator end() const
 	{
@@ -491,7 +1626,9 @@ public:
 	// Returns the maximum possible number of elements
 	Size max_size() const noexcept
 	{
-		return ((size_t)(-1) / sizeof(Type));
+		// The last position is reserved for InvalidPosition and the end() atom
+		auto Limit = std::min<std::size_t>(std::numeric_limits<Size>::max() - 1u, std::numeric_limits<std::size_t>::max() / sizeof(Type));
+		return static_cast<Size>(Limit);
 	}
 
 	// Reserves storage 
@@ -511,15 +1648,97 @@ public:
 		return mVectorCapacity;
 	}
 
-	// Reduces memory usage by freeing unused memory
+	// Reduces memory usage by freeing unused memory, in the data array and in the atom and mark tables
 	void shrink_to_fit()
 	{
-		// Exit early if the vector has the same capacity or less that the vector size
-		if (mVectorCapacity <= mVectorSize)
+		// Reallocate the entire array if it has more capacity than the vector size
+		if (mVectorCapacity > mVectorSize)
+			growVector(mVectorSize);
+
+		shrinkTables(1u, 1u);
+	}
+
+	// Releases memory automatically once the size falls below capacity / Divisor, in the data array and in the atom and mark tables
+	// A table shrinks to twice its size, so a vector going up and down around the same size doesn't reallocate every time
+	// 0 never shrinks (the default), clear() also releases the tables when a policy is set
+	// The marks of the erased elements stay in use until clear() or optimizeLayout(), only their spare capacity is released
+	void setShrinkPolicy(const Size& Divisor)
+	{
+		assert(Divisor != 1u && "Shrinking to twice the size needs a divisor of at least 2");
+
+		mShrinkDivisor = Divisor;
+		shrinkIfSparse();
+	}
+
+	// Returns the divisor of the shrink policy, 0 if the vector never shrinks by itself
+	const Size& shrinkPolicy() const noexcept
+	{
+		return mShrinkDivisor;
+	}
+
+	// Returns the bytes held by the elements, the atoms, the marks and the unused capacity of all of them
+	TVectorMemoryUsage memoryUsage() const noexcept
+	{
+		TVectorMemoryUsage Usage;
+		Usage.mPayloadBytes = std::size_t(mVectorSize) * sizeof(Type);
+		Usage.mAtomBytes = mAtomsVector.size() * sizeof(Atom);
+		Usage.mMarkBytes = mMarksVector.size() * sizeof(Mark) + mForwarding.size() * sizeof(MarkForward);
+
+		// The old array of a migration is counted whole, its elements are already in the payload
+		auto DataBytes = (std::size_t(mVectorCapacity) + (mOldVectorData ? std::size_t(mMigrationEnd) : 0u)) * sizeof(Data);
+		Usage.mSlackBytes = DataBytes - Usage.mPayloadBytes;
+		Usage.mSlackBytes += (mAtomsVector.capacity() - mAtomsVector.size()) * sizeof(Atom);
+		Usage.mSlackBytes += (mMarksVector.capacity() - mMarksVector.size()) * sizeof(Mark);
+		Usage.mSlackBytes += (mForwarding.capacity() - mForwarding.size()) * sizeof(MarkForward);
+
+		return Usage;
+	}
+
+	// Sets how many elements are moved to the new array for each operation after a growth, 0 moves them all at once
+	void setMigrationBudget(const Size& Budget)
+	{
+		// Complete the current migration before changing strategy
+		if (!Budget)
+			finishMigration();
+
+		mMigrationBudget = Budget;
+	}
+
+	// Returns the number of elements moved to the new array for each operation after a growth
+	const Size& migrationBudget() const noexcept
+	{
+		return mMigrationBudget;
+	}
+
+	// Splits the relocations of growths, insertions and erasures moving at least ThresholdBytes across the executor threads, 0 keeps them serial
+	// The shared TVectorThreadPool is used if no executor is given, destinations of at least StreamingBytes are written with non-temporal stores
+	void setParallelRelocation(std::size_t ThresholdBytes, TVectorExecutor Executor = TVectorExecutor(), std::size_t StreamingBytes = TVectorStreamingBytes)
+	{
+		if (!ThresholdBytes)
+		{
+			mParallelRelocation.reset();
 			return;
+		}
 
-		// Reallocate the entire array
-		growVector(mVectorSize);
+		if (!Executor)
+		{
+			auto& Pool = TVectorThreadPool::shared();
+			Executor = [&Pool](std::size_t Count, const std::function<void(std::size_t)>& Task) { Pool.run(Count, Task); };
+		}
+
+		mParallelRelocation = std::make_shared<const TParallelRelocation>(TParallelRelocation{ ThresholdBytes, StreamingBytes, std::move(Executor) });
+	}
+
+	// Returns the number of bytes from which the relocations are split across threads, 0 if they are serial
+	std::size_t parallelRelocationThreshold() const noexcept
+	{
+		return mParallelRelocation ? mParallelRelocation->mThresholdBytes : 0u;
+	}
+
+	// Checks whether some elements still live in the array used before the last growth
+	bool isMigrating() const noexcept
+	{
+		return mOldVectorData != nullptr;
 	}
 
 #pragma endregion
@@ -529,27 +1748,53 @@ public:
 	// Clears the contents
 	void clear() noexcept
 	{
+		++mEpoch;
+
+		// Everything is about to be released
+		preserveAll();
+
 		// Destroy all the elements
-		for (auto Index = 0u; Index < mVectorSize; ++Index)
-			reinterpret_cast<Type*>(mVectorData + Index)->~Type();
+		for (auto Index = Size(0); Index < mVectorSize; ++Index)
+			referenceCast(getData(Index)).~Type();
+
+		// Release the data arrays
+		delete[] mVectorData;
+		delete[] mOldVectorData;
+		mOldVectorData = nullptr;
+		mMigratedCount = mMigrationEnd = 0u;
 
 		// Clean the atom vector
 		mAtomsVector.clear();
 
 		// Clean the marks vector (increase by one all the marks ID)
 		mMarksVector.clear();
+		mForwarding.clear();
 		++mIteratorDefaultID;
 
-		// Reset the vector size
+		// Nothing is forwarded anymore, so a wrapped ID must not be taken for an old one
+		mLayoutBaseID = 0u;
+
+		// With a shrink policy the tables release their peak capacity too
+		if (mShrinkDivisor)
+		{
+			std::vector<Atom>().swap(mAtomsVector);
+			std::vector<Mark>().swap(mMarksVector);
+			std::vector<MarkForward>().swap(mForwarding);
+		}
+
+		// Reset the vector size, no element written in place is left to report
 		mVectorSize = 0u;
 		mVectorCapacity = 1u;
+		mWrittenFirst = mWrittenLast = 0u;
 
 		init();
+
+		notifyMutation(TVectorOp::Clear, 0u, 0u);
 	}
 
 	// inserts value before pos
 	template<class... TArgs>
-	Iterator emplace(CIterator& InsertPosition, TArgs&&... Args)
+	Iterator emplace(const CIterator& InsertPosition, TArgs&&... Args)
 	{
 		/*
 		To insert an element at an arbitrary position:
@@ -571,25 +1816,47 @@ public:
 		if (InsertPosition == end())
 			return emplaceBack(std::forward<TArgs>(Args)...);
 
+		// The elements written in place are reported at their current position
+		publishWrites();
+
+		++mEpoch;
+
 		// Check where in the data array we are inserting the value
 		auto Index = getDataIndexFromIterator(InsertPosition);
 
+		// Shifting needs all the elements in the same array
+		finishMigration();
+
 		// Check if we have enough space in the data array 
 		if (mVectorSize + 1 > mVectorCapacity)
-			growVector(mVectorCapacity * 2);
+			growVector(grownCapacity(mVectorSize + 1u));
+
+		// Keep for the snapshots what's about to move
+		preserveTableGrowth(1u);
+		preserveData(Index, mVectorSize);
+		preserveAtoms(Index, static_cast<Position>(mAtomsVector.size()));
+		preserveMarks(0u, static_cast<Position>(mMarksVector.size()));
 
 		// Shift all the data array past the insertion position to the right
 		shiftArrayRight(Index, 1);
 
-		// Create the new element in place at position pointed by the "InsertPosition" iterator
-		new(mVectorData + Index) Type(std::forward<TArgs>(Args)...);
+		// Create the new element in place at position pointed by the "InsertPosition" iterator, closing the gap if it throws
+		try
+		{
+			new(mVectorData + Index) Type(std::forward<TArgs>(Args)...);
+		}
+		catch (...)
+		{
+			TParallelRelocator<Type>::relocateLeft(mVectorData + Index, mVectorData + Index + 1, mVectorSize - Index, mParallelRelocation.get());
+			throw;
+		}
 
 		// Shift to the right all the iterator structure (atom, mark) used by the value past the insertion point, except for the last (that one is the end() iterator structure)
 		shiftAtomVectorRight(Index);
 		shiftMarkVectorRight(Index);
 
 		// Point the atom in the insert position to the pointed mark pos
-		auto NewMarkPos = static_cast<Position>(mMarksVector.size()) - 1;
+		auto NewMarkPos = static_cast<Position>(mMarksVector.size() - 1);
 		mAtomsVector[Index].mMarkPos = NewMarkPos;
 		mMarksVector[NewMarkPos] = { Index, mIteratorDefaultID };
 
@@ -600,29 +1867,32 @@ public:
 		mAtomsVector.emplace_back(mVectorSize, NewMarkPos + 1);
 		mMarksVector.emplace_back(mVectorSize, mIteratorDefaultID);
 
+		notifyMutation(TVectorOp::Emplace, Index, NewMarkPos);
+		markDirty(Index, mVectorSize);
+
 		// Return an iterator to the newly added iterator
 		return Iterator(Index, this);
 	}
-	Iterator insert(CIterator& InsertPosition, const Type& Value)
+	Iterator insert(const CIterator& InsertPosition, const Type& Value)
 	{
 		// use the emplace function
 		return emplace(InsertPosition, Value);
 	}
-	Iterator insert(CIterator& InsertPosition, Type&& Value)
+	Iterator insert(const CIterator& InsertPosition, Type&& Value)
 	{
 		// use the emplace function
 		return emplace(InsertPosition, std::move(Value));
 	}
 
 	// Inserts count copies of the value before pos
-	Iterator insert(CIterator& InsertPosition, Size Count, const Type& Value)
+	Iterator insert(const CIterator& InsertPosition, Size Count, const Type& Value)
 	{
 		// Copy the passed iterator
-		Iterator Temp = InsertPosition;
+		Iterator Temp(InsertPosition.mMarkPos, InsertPosition.mIteratorID, this);
 		auto InsertPosIndex = getDataIndexFromIterator(InsertPosition);
 
 		// Create a "Count" number of "Value"
-		for (auto Index = 0u; Index < Count; ++Index)
+		for (auto Index = Size(0); Index < Count; ++Index)
 		{
 			Temp = emplace(Temp, Value);
 			++Temp;
@@ -634,10 +1904,10 @@ public:
 
 	// Inserts elements from range [first, last) before pos
 	template<class InputIt>
-	Iterator insert(CIterator& InsertPosition, InputIt First, InputIt Last)
+	Iterator insert(const CIterator& InsertPosition, InputIt First, InputIt Last)
 	{
 		// Copy the passed iterator
-		Iterator Temp = InsertPosition;
+		Iterator Temp(InsertPosition.mMarkPos, InsertPosition.mIteratorID, this);
 		auto InsertPosIndex = getDataIndexFromIterator(InsertPosition);
 
 		// Copy all the value in the range (First, Last)
@@ -652,10 +1922,10 @@ public:
 	}
 
 	// Inserts elements from initializer list ilist before pos
-	Iterator insert(CIterator& InsertPosition, std::initializer_list<Type> IList)
+	Iterator insert(const CIterator& InsertPosition, std::initializer_list<Type> IList)
 	{
 		// Copy the passed iterator
-		Iterator Temp = InsertPosition;
+		Iterator Temp(InsertPosition.mMarkPos, InsertPosition.mIteratorID, this);
 		auto InsertPosIndex = getDataIndexFromIterator(InsertPosition);
 
 		// Copy all the value in the range (First, Last)
@@ -671,7 +1941,7 @@ public:
 	}
 
 	// Removes specified elements from the container.
-	Iterator erase(CIterator& DeletePosition)
+	Iterator erase(const CIterator& DeletePosition)
 	{
 		/*
 		To delete an element:
@@ -683,22 +1953,33 @@ public:
 
 		// If the delete position is the end() iterator skip this function now
 		if (DeletePosition == end())
-			return DeletePosition;
+			return end();
+
+		// The elements written in place are reported at their current position
+		publishWrites();
+
+		++mEpoch;
 
 		// Get the index of the value to remove
 		auto Index = getDataIndexFromIterator(DeletePosition);
 
+		// Shifting needs all the elements in the same array
+		finishMigration();
+
+		// Keep for the snapshots what's about to move
+		preserveData(Index, mVectorSize);
+		preserveAtoms(Index, static_cast<Position>(mAtomsVector.size()));
+		preserveMarks(0u, static_cast<Position>(mMarksVector.size()));
+
 		// Remove data from the data array by ...
 		// Calling the destructor on the data to remove ...
 		referenceCast(mVectorData[Index]).~Type();
 
-		// Shifting the data array to the left ...
+		// And relocating the rest of the data array to the left
 		shiftArrayLeft(Index, 1);
 
-		// And erasing the last element (calling it's destructor)
-		referenceCast(mVectorData[mVectorSize - 1]).~Type();
-
 		// Invalidates the connected mark
+		notifyMutation(TVectorOp::Erase, Index, getMarkPos(DeletePosition));
 		++getMarkFromIterator(DeletePosition).mIteratorID;
 
 		// Delete the connected atom
@@ -707,49 +1988,297 @@ public:
 
 		// Decrement the size of the vector
 		--mVectorSize;
+		markDirty(Index, mVectorSize);
 
 		// Set the last atom as the end()
-		auto NewMarkPos = static_cast<Position>(mMarksVector.size()) - 1;
+		auto NewMarkPos = static_cast<Position>(mMarksVector.size() - 1);
 		mAtomsVector[mVectorSize] = { mVectorSize, NewMarkPos };
 		mMarksVector[NewMarkPos] = { mVectorSize, mIteratorDefaultID };
 
+		shrinkIfSparse();
+
 		return Iterator(Index, this);
 	}
-	Iterator erase(CIterator& First, CIterator& Last)
+	Iterator erase(const CIterator& First, const CIterator& Last)
 	{
-		// Use the erase function with one parameter
-		Iterator Temp = Last;
-		auto Index = getDataIndexFromIterator(First);
+		// Use the erase function with one parameter, starting from the back so less elements are shifted
+		auto FirstIndex = getDataIndexFromIterator(First);
+		auto LastIndex = getDataIndexFromIterator(Last);
 
-		while (--Temp > First)
-			erase(Temp);
+		for (auto Index = LastIndex; Index > FirstIndex; --Index)
+			erase(Iterator(Index - 1, this));
 
-		// Return an iterator to the first added element
-		return Iterator(Index, this);
+		// Return an iterator to the element that followed the erased range
+		return Iterator(FirstIndex, this);
 	}
 
-	// Create an element using the passed arguments at the end of the vector
-	template<class... TArgs>
-	Iterator emplaceBack(TArgs&&... Args)
+	// Removes the elements for which Predicate(Element) is true with a single stable pass over the data, atoms and marks
+	// Returns the number of removed elements
+	template <class TPredicate>
+	Size eraseIf(TPredicate&& Predicate)
 	{
-		/*
-		To insert an element at the end:
-		1) If we won't have enough space for a new element grows the vector
-		2) Create the new element in place at the end of the data vector
-		3) Create the right iterator structure (atom, mark) in place of the end() iterator
-		4) Create a new end() iterator
-		5) Increase the vector size
+		// The elements written in place are reported at their current position
+		publishWrites();
+
+		++mEpoch;
+
+		// Compacting needs all the elements in the same array
+		finishMigration();
+
+		// Every kept element moves down to the write position, with its atom
+		auto Write = Size(0);
+		auto Read = Size(0);
+		try
+		{
+			for (; Read < mVectorSize; ++Read)
+			{
+				auto MarkPos = mAtomsVector[Read].mMarkPos;
+				if (Predicate(static_cast<CReference>(referenceCast(mVectorData[Read]))))
+				{
+					// Keep for the snapshots what's about to move, from the first removed element on
+					if (Write == Read)
+					{
+						preserveData(Read, mVectorSize);
+						preserveAtoms(Read, static_cast<Position>(mAtomsVector.size()));
+						preserveMarks(0u, static_cast<Position>(mMarksVector.size()));
+						markDirty(Read, mVectorSize);
+					}
+
+					// Destroy the element and invalidate its mark, observers see the erasures in order
+					referenceCast(mVectorData[Read]).~Type();
+					notifyMutation(TVectorOp::Erase, Write, MarkPos);
+					++mMarksVector[MarkPos].mIteratorID;
+					continue;
+				}
+
+				if (Write != Read)
+				{
+					TRelocator<Type>::relocate(mVectorData + Write, mVectorData + Read, 1u);
+					mAtomsVector[Write] = { Write, MarkPos };
+					mMarksVector[MarkPos].mAtomPos = Write;
+				}
+				++Write;
+			}
+		}
+		catch (...)
+		{
+			// The elements not visited yet close the gap, so the vector stays consistent
+			closeGap(Write, Read);
+			throw;
+		}
+
+		// Move the end() iterator structure down
+		closeGap(Write, Read);
+		shrinkIfSparse();
+
+		return static_cast<Size>(Read - Write);
+	}
+
+	// Keeps only the elements for which Predicate(Element) is true, see eraseIf
+	// Returns the number of removed elements
+	template <class TPredicate>
+	Size retainIf(TPredicate&& Predicate)
+	{
+		return eraseIf([&Predicate](CReference Element) { return !Predicate(Element); });
+	}
+
+	// Attach an observer that will receive the mutations (nullptr detaches it), it receives the current state right away
+	void setObserver(TVectorObserver* Observer)
+	{
+		static_assert(std::is_trivially_copyable<Type>::value, "Observers receive the elements as raw bytes");
+
+		// The previous observer gets what was written for it
+		publishWrites();
+		finishMigration();
+
+		mObserver = Observer;
+		notifyState();
+	}
+
+	// Send to the observer the elements written in place since the last call, as Assign records of at most about 4KB each
+	// A write through a reference only happens after the accessor returned, so the vector can't report it by itself:
+	// call this once the writes are done. Erasing, inserting in the middle, popBack() and mergeSorted() call it first,
+	// so a write through a reference or pointer kept across them (or across this call) isn't reported
+	void publishWrites()
+	{
+		auto First = mWrittenFirst;
+		auto Last = mWrittenLast < mVectorSize ? mWrittenLast : mVectorSize;
+		mWrittenFirst = mWrittenLast = 0u;
+		if (!mObserver || First >= Last)
+			return;
+
+		// The records read a single data array
+		finishMigration();
+
+		auto PageElements = Position(1) << TVectorDirtyPages::pageShift(sizeof(Type));
+		for (auto Index = First; Index < Last; Index += PageElements)
+		{
+			auto Count = Last - Index < PageElements ? Last - Index : PageElements;
+			auto MarkPos = mAtomsVector[Index].mMarkPos;
+			mObserver->onMutation(TVectorOp::Assign, Index, MarkPos, mMarksVector[MarkPos].mIteratorID, mVectorData + Index, Count * sizeof(Type));
+		}
+	}
+
+	// Record the data ranges written from now on, at the granularity of about 4KB pages, see consumeDirty()
+	// Turning it on makes the whole vector dirty, so the first consumer processes everything
+	// Only the mutable accessors and iterators mark pages, the const ones and CIterator never do
+	void setDirtyTracking(bool Enabled)
+	{
+		if (!Enabled)
+		{
+			mDirtyPages.reset();
+			return;
+		}
+
+		if (!mDirtyPages)
+			mDirtyPages.reset(new TVectorDirtyPages(TVectorDirtyPages::pageShift(sizeof(Type))));
+		mDirtyPages->markAll();
+	}
+	bool dirtyTracking() const noexcept
+	{
+		return mDirtyPages != nullptr;
+	}
+
+	// Calls Function(First, Last) for every range of data indices written since the last call, and forgets them
+	// Writes through operator[], at(), data() and the iterators count, as well as everything inserting, erasing or shifting elements
+	// Only the ranges below size() are reported, a consumer learns about a removed tail from the size
+	// What Function writes through the vector is forgotten with the rest
+	template <class TFunction>
+	void consumeDirty(TFunction&& Function)
+	{
+		assert(mDirtyPages && "Dirty tracking is off, call setDirtyTracking(true)");
+
+		mDirtyPages->consume(mVectorSize, [&Function](std::size_t First, std::size_t Last) { Function(static_cast<Position>(First), static_cast<Position>(Last)); });
+	}
+	std::vector<std::pair<Position, Position>> consumeDirty()
+	{
+		std::vector<std::pair<Position, Position>> Ranges;
+		consumeDirty([&Ranges](const Position& First, const Position& Last) { Ranges.emplace_back(First, Last); });
+
+		return Ranges;
+	}
+
+	// Replace the whole vector, iterator structures and forwarding of optimizeLayout() included, with the state sent to a TVectorObserver
+	void loadState(const TVectorState& State)
+	{
+		static_assert(std::is_trivially_copyable<Type>::value, "The state holds the elements as raw bytes");
+
+		clear();
+
+		// Copy the iterator structures (atom, mark) as they are
+		mAtomsVector.resize(State.mAtomsBytes / sizeof(Atom));
+		mMarksVector.resize(State.mMarksBytes / sizeof(Mark));
+		if (State.mAtomsBytes)
+			std::memcpy(mAtomsVector.data(), State.mAtoms, State.mAtomsBytes);
+		if (State.mMarksBytes)
+			std::memcpy(mMarksVector.data(), State.mMarks, State.mMarksBytes);
+
+		// The iterators created before the last optimizeLayout() keep being forwarded for what's left of the grace period
+		mForwarding.resize(State.mForwardingBytes / sizeof(MarkForward));
+		if (State.mForwardingBytes)
+			std::memcpy(mForwarding.data(), State.mForwarding, State.mForwardingBytes);
+		mForwardingEpoch = mEpoch;
+		mForwardingGrace = State.mForwardingGrace;
+		mLayoutBaseID = static_cast<TID>(State.mLayoutBaseID);
+
+		// Copy the data
+		reserve(static_cast<Size>(State.mSize));
+		if (State.mSize)
+			std::memcpy(mVectorData, State.mData, static_cast<std::size_t>(State.mSize) * sizeof(Type));
+
+		mVectorSize = static_cast<Size>(State.mSize);
+		mIteratorDefaultID = static_cast<TID>(State.mDefaultID);
+		markDirty(0u, mVectorSize);
+	}
+
+	// Take an immutable view of the vector, it costs a few allocations and the later changes copy only the chunks they touch
+	Snapshot snapshot()
+	{
+		static_assert(std::is_trivially_copyable<Type>::value, "Snapshots copy the elements as raw bytes");
+
+		// The snapshot reads a single data array
+		finishMigration();
+
+		Snapshot View;
+		auto State = std::make_shared<SnapshotState>(*this);
+		mSnapshots.emplace_back(State);
+		View.mState = std::move(State);
+
+		return View;
+	}
+
+	// Exchanges the contents with another vector
+	void swap(TVector& Other) noexcept
+	{
+		std::swap(mVectorData, Other.mVectorData);
+		std::swap(mOldVectorData, Other.mOldVectorData);
+		std::swap(mVectorSize, Other.mVectorSize);
+		std::swap(mVectorCapacity, Other.mVectorCapacity);
+		std::swap(mMigratedCount, Other.mMigratedCount);
+		std::swap(mMigrationEnd, Other.mMigrationEnd);
+		std::swap(mMigrationBudget, Other.mMigrationBudget);
+		std::swap(mShrinkDivisor, Other.mShrinkDivisor);
+		mParallelRelocation.swap(Other.mParallelRelocation);
+		std::swap(mIteratorDefaultID, Other.mIteratorDefaultID);
+		mAtomsVector.swap(Other.mAtomsVector);
+		mMarksVector.swap(Other.mMarksVector);
+		mSnapshots.swap(Other.mSnapshots);
+		std::swap(mLayoutBaseID, Other.mLayoutBaseID);
+		mForwarding.swap(Other.mForwarding);
+		std::swap(mForwardingEpoch, Other.mForwardingEpoch);
+		std::swap(mForwardingGrace, Other.mForwardingGrace);
+
+		// The iterators of both vectors now look at different data
+		++mEpoch;
+		++Other.mEpoch;
+
+		// Observers and dirty tracking stay with their vector, but the contents changed
+		notifyState();
+		Other.notifyState();
+		if (mDirtyPages)
+			mDirtyPages->markAll();
+		if (Other.mDirtyPages)
+			Other.mDirtyPages->markAll();
+	}
+
+	// Create an element using the passed arguments at the end of the vector
+	template<class... TArgs>
+	Iterator emplaceBack(TArgs&&... Args)
+	{
+		/*
+		To insert an element at the end:
+		1) If we won't have enough space for a new element grows the vector
+		2) Create the new element in place at the end of the data vector
+		3) Create the right iterator structure (atom, mark) in place of the end() iterator
+		4) Create a new end() iterator
+		5) Increase the vector size
 		*/
 
+		++mEpoch;
+
 		// If we won't have enough space for a new element grows the vector 
 		if (mVectorSize + 1 > mVectorCapacity)
-			growVector(mVectorCapacity * 2);
+		{
+			if (mMigrationBudget)
+				beginMigration(grownCapacity(mVectorSize + 1u));
+			else
+				growVector(grownCapacity(mVectorSize + 1u));
+		}
 
-		// Create the new element in place at the end of the data vector
+		// Keep for the snapshots the end() iterator structure that's about to change
+		preserveTableGrowth(1u);
+		preserveAtoms(mVectorSize, mVectorSize + 1);
+		preserveMarks(static_cast<Position>(mMarksVector.size() - 1), static_cast<Position>(mMarksVector.size()));
+
+		// Create the new element in place at the end of the data vector (always past the migrating elements)
 		new(mVectorData + mVectorSize) Type(std::forward<TArgs>(Args)...);
 
+		// Move a bounded number of elements out of the old array
+		if (mOldVectorData)
+			migrateElements(mMigrationBudget);
+
 		// Create the right iterator structure (atom, mark) in place of the end() iterator
-		auto NewMarkPos = static_cast<Position>(mMarksVector.size()) - 1;
+		auto NewMarkPos = static_cast<Position>(mMarksVector.size() - 1);
 		mAtomsVector[mVectorSize] = { mVectorSize, NewMarkPos };
 		mMarksVector[NewMarkPos] = { mVectorSize, mIteratorDefaultID };
 
@@ -760,6 +2289,9 @@ public:
 		mAtomsVector.emplace_back(mVectorSize, NewMarkPos + 1);
 		mMarksVector.emplace_back(mVectorSize, mIteratorDefaultID);
 
+		notifyMutation(TVectorOp::EmplaceBack, mVectorSize - 1, NewMarkPos);
+		markDirty(mVectorSize - 1, mVectorSize);
+
 		// Return an iterator to the newly added iterator
 		return Iterator(mVectorSize - 1, this);
 	}
@@ -778,24 +2310,168 @@ public:
 		return emplaceBack(std::move(Element));
 	}
 
+	// Inserts the sorted range [first, last) in a vector already sorted by the same criteria, shifting each element only once
+	// The new elements are placed after the equivalent elements already in the vector, returns the number of inserted elements
+	template<class BidirIt, class Compare>
+	Size mergeSorted(BidirIt First, BidirIt Last, Compare Comp)
+	{
+		/*
+		To merge a sorted range:
+		1) Make room for all the new elements and their iterator structures (atom, mark) at once
+		2) Walk the vector and the range from the back, relocating each old element directly to its final position
+		   and constructing each new element in the gap that is left
+		3) Keep the atoms in step with the data, the marks of the moved atoms follow them
+		4) The old end() iterator structure belongs to the first new element, create a new end() iterator
+		*/
+
+		// The elements written in place are reported at their current position
+		publishWrites();
+
+		// The new elements are constructed and the old ones relocated in the middle of the merge, where any of them throwing would leave a hole
+		return mergeSortedRange(First, Last, Comp, std::integral_constant<bool, std::is_nothrow_constructible<Type, decltype(*First)>::value && TRelocator<Type>::IsNoexcept>());
+	}
+
+	// Create a specified number of elements at the end of the vector, each one constructed from Generator(Index)
+	template<class TGenerator>
+	Iterator emplaceBackN(const Size& Count, TGenerator&& Generator)
+	{
+		return appendElements(Count, [&Generator](Pointer Element, const Size& Index) { new(Element) Type(Generator(Index)); });
+	}
+
+	// Copy the elements from range [first, last) at the end of the vector
+	template<class InputIt>
+	Iterator append(InputIt First, InputIt Last)
+	{
+		// Single pass ranges can't be counted in advance, so they're appended one by one
+		if (!std::is_base_of<std::forward_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>::value)
+		{
+			auto FirstIndex = mVectorSize;
+			while (First != Last)
+				emplaceBack(*(First++));
+
+			return Iterator(FirstIndex, this);
+		}
+
+		auto Count = static_cast<Size>(std::distance(First, Last));
+		return appendElements(Count, [&First](Pointer Element, const Size&) { new(Element) Type(*(First++)); });
+	}
+
+	// Copy the elements from initializer list ilist at the end of the vector
+	Iterator append(std::initializer_list<Type> IList)
+	{
+		return append(IList.begin(), IList.end());
+	}
+
+	// Append the elements produced by Source(Pointer, MaxCount), called until it returns 0, one chunk at a time
+	// Source constructs up to MaxCount elements at the passed address and returns how many it constructed, if it throws it must destroy them first
+	// The storage is reserved a chunk ahead and every chunk is published with its iterator structures (atom, mark) in a single step
+	template<class TSource>
+	Size appendFrom(TSource&& Source, const Size& ChunkSize = 4096u)
+	{
+		assert(ChunkSize > 0);
+
+		auto FirstIndex = mVectorSize;
+		for (;;)
+		{
+			++mEpoch;
+
+			// Reserve the space for the next chunk
+			if (mVectorSize + ChunkSize > mVectorCapacity)
+				growVector(grownCapacity(std::size_t(mVectorSize) + ChunkSize));
+
+			// Let the source construct the chunk in the uninitialized tail of the data array
+			auto Constructed = static_cast<Size>(Source(pointerCast(mVectorData + mVectorSize), ChunkSize));
+			assert(Constructed <= ChunkSize);
+			if (!Constructed)
+				break;
+
+			// Publish the whole chunk, destroying it if the iterator structures can't grow
+			try
+			{
+				publishElements(Constructed);
+			}
+			catch (...)
+			{
+				for (auto Index = Size(0); Index < Constructed; ++Index)
+					referenceCast(mVectorData[mVectorSize + Index]).~Type();
+
+				throw;
+			}
+		}
+
+		return mVectorSize - FirstIndex;
+	}
+
+	// Changes the number of elements stored, new elements are default constructed
+	void resize(const Size& NewSize)
+	{
+		while (mVectorSize > NewSize)
+			popBack();
+
+		appendElements(NewSize - mVectorSize, [](Pointer Element, const Size&) { new(Element) Type(); });
+	}
+
+	// Changes the number of elements stored, new elements are copies of value
+	void resize(const Size& NewSize, const Type& Value)
+	{
+		while (mVectorSize > NewSize)
+			popBack();
+
+		appendElements(NewSize - mVectorSize, [&Value](Pointer Element, const Size&) { new(Element) Type(Value); });
+	}
+
+	// Replaces the contents with count copies of value
+	void assign(const Size& Count, const Type& Value)
+	{
+		clear();
+		resize(Count, Value);
+	}
+
+	// Replaces the contents with copies of those in the range [first, last)
+	template<class InputIt>
+	void assign(InputIt First, InputIt Last)
+	{
+		clear();
+		append(First, Last);
+	}
+
+	// Replaces the contents with the elements from the initializer list ilist
+	void assign(std::initializer_list<Type> IList)
+	{
+		clear();
+		append(IList);
+	}
+
 	// Remove the last element in the vector
 	void popBack()
 	{	
+		// The elements written in place are reported while they are all there
+		publishWrites();
+
+		++mEpoch;
+
 		// Index of the data to remove
 		auto Index = mVectorSize - 1;
 
-		// Remove data from the data array by ...
-		// Calling the destructor on the data to remove ...
-		referenceCast(mVectorData[Index]).~Type();
+		// Keep for the snapshots the removed element and its iterator structures (atom, mark)
+		preserveData(Index, Index + 1);
+		preserveAtoms(Index, Index + 2);
+		preserveMarks(mAtomsVector[Index].mMarkPos, mAtomsVector[Index].mMarkPos + 1);
+		preserveMarks(mAtomsVector[Index + 1].mMarkPos, mAtomsVector[Index + 1].mMarkPos + 1);
 
-		// Shifting the data array to the left ...
-		shiftArrayLeft(Index, 1);
+		// Remove data from the data array by calling the destructor on the data to remove, nothing comes after it
+		referenceCast(getData(Index)).~Type();
 
-		// And erasing the last element (calling it's destructor)
-		referenceCast(mVectorData[Index - 1]).~Type();
+		// Popping an element that hasn't been migrated yet shrinks the migration (and may complete it)
+		if (mOldVectorData && Index < mMigrationEnd)
+		{
+			mMigrationEnd = Index;
+			migrateElements(0u);
+		}
 
 		// Invalidates the connected mark
-		++getMarkFromAtom(mAtomsVector.back()).mIteratorID;
+		notifyMutation(TVectorOp::PopBack, Index, mAtomsVector[Index].mMarkPos);
+		++getMarkFromAtom(mAtomsVector[Index]).mIteratorID;
 
 		// Delete the connected atom
 		shiftAtomVectorLeft(Index, 1);
@@ -805,9 +2481,86 @@ public:
 		--mVectorSize;
 
 		// Set the last atom as the end()
-		auto NewMarkPos = static_cast<Position>(mMarksVector.size()) - 1;
+		auto NewMarkPos = static_cast<Position>(mMarksVector.size() - 1);
 		mAtomsVector[mVectorSize] = { mVectorSize, NewMarkPos };
 		mMarksVector[NewMarkPos] = { mVectorSize, mIteratorDefaultID };
+
+		shrinkIfSparse();
+	}
+
+	// Starts recording positional inserts and erasures to apply at once with MutationBatch::commit()
+	MutationBatch beginBatch()
+	{
+		return MutationBatch(this);
+	}
+
+	// Renumber the marks in the order of the data and drop the ones of the erased elements, so iterating reads the marks sequentially
+	// Returns the remap for the iterators created before, GraceEpochs > 0 keeps them working on their own for that many modifications
+	LayoutRemap optimizeLayout(const std::uint64_t& GraceEpochs = 0u)
+	{
+		/*
+		To optimize the layout:
+		1) Pick an ID greater than any ID in use, all the iterators created before will have a lower one
+		2) Record where the mark of every atom is going, with the ID the iterators must have to follow it
+		3) Give to the atom N the mark N, the mark table shrinks to the atom table size
+		*/
+
+		++mEpoch;
+
+		// Keep for the snapshots the iterator structures
+		preserveAtoms(0u, static_cast<Position>(mAtomsVector.size()));
+		preserveMarks(0u, static_cast<Position>(mMarksVector.size()));
+
+		// Pick an ID greater than any ID in use
+		auto MaxID = mIteratorDefaultID;
+		for (auto& OldMark : mMarksVector)
+			MaxID = OldMark.mIteratorID > MaxID ? OldMark.mIteratorID : MaxID;
+
+		// If there's none left every mark starts over from 0, the old iterators can't be told apart by their ID anymore so none is forwarded
+		auto Rebase = MaxID == std::numeric_limits<TID>::max();
+		auto NewID = Rebase ? TID(0) : static_cast<TID>(MaxID + 1u);
+
+		// Record where the mark of every atom is going
+		LayoutRemap Remap;
+		Remap.mForwarding.assign(mMarksVector.size(), { InvalidPosition, InvalidID });
+		Remap.mNewID = NewID;
+		Remap.mRebased = Rebase;
+		Remap.mParentVector = this;
+		for (auto AtomPos = Position(0); AtomPos < mAtomsVector.size(); ++AtomPos)
+			Remap.mForwarding[mAtomsVector[AtomPos].mMarkPos] = { AtomPos, mMarksVector[mAtomsVector[AtomPos].mMarkPos].mIteratorID };
+
+		// Give to the atom N the mark N
+		std::vector<Mark> NewMarks;
+		NewMarks.reserve(mAtomsVector.size());
+		for (auto AtomPos = Position(0); AtomPos < mAtomsVector.size(); ++AtomPos)
+		{
+			mAtomsVector[AtomPos].mMarkPos = AtomPos;
+			NewMarks.emplace_back(AtomPos, NewID);
+		}
+		mMarksVector.swap(NewMarks);
+
+		mIteratorDefaultID = NewID;
+		mLayoutBaseID = NewID;
+
+		// Keep forwarding the old iterators during the grace period
+		if (GraceEpochs && !Rebase)
+			mForwarding = Remap.mForwarding;
+		else
+			std::vector<MarkForward>().swap(mForwarding);
+		mForwardingEpoch = mEpoch;
+		mForwardingGrace = GraceEpochs;
+
+		// Observers repeat the renumbering, the marks and the IDs of the follower are the same
+		if (mObserver)
+			mObserver->onMutation(TVectorOp::OptimizeLayout, 0u, 0u, GraceEpochs, nullptr, 0u);
+
+		return Remap;
+	}
+
+	// Release the forwarding table of optimizeLayout() before the end of the grace period
+	void releaseForwarding()
+	{
+		std::vector<MarkForward>().swap(mForwarding);
 	}
 
 #pragma endregion
@@ -832,6 +2585,164 @@ private:
 		return reinterpret_cast<Pointer>(DataToCast);
 	}
 
+	// mergeSorted() of elements that can't throw while being constructed or relocated
+	template<class BidirIt, class Compare>
+	Size mergeSortedRange(BidirIt First, BidirIt Last, Compare Comp, std::true_type)
+	{
+		auto Count = static_cast<Size>(std::distance(First, Last));
+		if (!Count)
+			return 0u;
+
+		++mEpoch;
+
+		// Make room for all the new elements and their iterator structures (atom, mark) at once
+		if (mVectorSize + Count > mVectorCapacity)
+			growVector(grownCapacity(std::size_t(mVectorSize) + Count));
+		else
+			finishMigration();
+
+		// Most of the vector moves, so the snapshots keep all of it
+		preserveAll();
+
+		assert(mMarksVector.size() + Count < InvalidPosition && "Too many insertions for the position type, call clear() or optimizeLayout()");
+
+		auto FirstMarkPos = static_cast<Position>(mMarksVector.size() - 1);
+		mAtomsVector.resize(mVectorSize + Count + 1);
+		mMarksVector.resize(FirstMarkPos + Count + 1);
+
+		// Walk the vector and the range from the back
+		auto OldIndex = mVectorSize;
+		auto NewIndex = Count;
+		auto Destination = static_cast<Position>(mVectorSize + Count);
+		while (NewIndex > 0)
+		{
+			--Destination;
+
+			if (OldIndex > 0 && Comp(*std::prev(Last), referenceCast(mVectorData[OldIndex - 1])))
+			{
+				// Relocate the old element and its atom to the final position
+				--OldIndex;
+				TRelocator<Type>::relocate(mVectorData + Destination, mVectorData + OldIndex, 1);
+				mAtomsVector[Destination] = { Destination, mAtomsVector[OldIndex].mMarkPos };
+				mMarksVector[mAtomsVector[Destination].mMarkPos].mAtomPos = Destination;
+			}
+			else
+			{
+				// Construct the new element in the gap
+				--NewIndex;
+				new(mVectorData + Destination) Type(*(--Last));
+				mAtomsVector[Destination] = { Destination, static_cast<Position>(FirstMarkPos + NewIndex) };
+				mMarksVector[FirstMarkPos + NewIndex] = { Destination, mIteratorDefaultID };
+			}
+		}
+
+		// Increase the vector size, everything from the lowest insertion on moved
+		mVectorSize += Count;
+		markDirty(Destination, mVectorSize);
+
+		// Create a new end() iterator
+		mAtomsVector[mVectorSize] = { mVectorSize, FirstMarkPos + Count };
+		mMarksVector[FirstMarkPos + Count] = { mVectorSize, mIteratorDefaultID };
+
+		// Observers see the same sequence of emplace, in order of position, that would have built the vector
+		if (mObserver)
+			for (NewIndex = 0; NewIndex < Count; ++NewIndex)
+				notifyMutation(TVectorOp::Emplace, mMarksVector[FirstMarkPos + NewIndex].mAtomPos, FirstMarkPos + NewIndex);
+
+		return Count;
+	}
+
+	// mergeSorted() of elements that may throw, they are staged first so nothing throws in the middle of the merge
+	// If relocating the old elements may throw too, the merge builds a new array
+	template<class BidirIt, class Compare>
+	Size mergeSortedRange(BidirIt First, BidirIt Last, Compare Comp, std::false_type)
+	{
+		std::vector<Type> Staging(First, Last);
+
+		// Merge the staged copies in place if they can be moved safely, else into a new array
+		return mergeStaged(Staging, Comp, std::integral_constant<bool, std::is_nothrow_move_constructible<Type>::value && TRelocator<Type>::IsNoexcept>());
+	}
+	template<class Compare>
+	Size mergeStaged(std::vector<Type>& Staging, Compare Comp, std::true_type)
+	{
+		return mergeSorted(std::make_move_iterator(Staging.begin()), std::make_move_iterator(Staging.end()), Comp);
+	}
+	// Merge into a new array, copying the old elements, so the vector is untouched if anything throws
+	template<class Compare>
+	Size mergeStaged(std::vector<Type>& Staging, Compare Comp, std::false_type)
+	{
+		auto Count = static_cast<Size>(Staging.size());
+		if (!Count)
+			return 0u;
+
+		assert(mMarksVector.size() + Count < InvalidPosition && "Too many insertions for the position type, call clear() or optimizeLayout()");
+
+		finishMigration();
+
+		// Allocate everything first
+		auto NewCapacity = mVectorSize + Count > mVectorCapacity ? grownCapacity(std::size_t(mVectorSize) + Count) : mVectorCapacity;
+		std::unique_ptr<Data[]> NewData(new Data[NewCapacity]);
+		std::vector<Atom> NewAtoms(mVectorSize + Count + 1);
+		auto FirstMarkPos = static_cast<Position>(mMarksVector.size() - 1);
+		mMarksVector.reserve(FirstMarkPos + Count + 1);
+
+		// Walk the vector and the staged elements from the front, the old elements go before the equivalent new ones
+		auto OldIndex = Size(0);
+		auto NewIndex = Size(0);
+		auto Destination = Position(0);
+		try
+		{
+			for (; Destination < mVectorSize + Count; ++Destination)
+			{
+				if (NewIndex == Count || (OldIndex < mVectorSize && !Comp(Staging[NewIndex], referenceCast(mVectorData[OldIndex]))))
+				{
+					new(NewData.get() + Destination) Type(referenceCast(mVectorData[OldIndex]));
+					NewAtoms[Destination] = { Destination, mAtomsVector[OldIndex++].mMarkPos };
+				}
+				else
+				{
+					new(NewData.get() + Destination) Type(std::move(Staging[NewIndex]));
+					NewAtoms[Destination] = { Destination, static_cast<Position>(FirstMarkPos + NewIndex++) };
+				}
+			}
+		}
+		catch (...)
+		{
+			while (Destination > 0)
+				referenceCast(NewData[--Destination]).~Type();
+
+			throw;
+		}
+
+		// Nothing can throw from here on, the snapshots keep the old contents
+		++mEpoch;
+		preserveAll();
+
+		for (auto Index = Size(0); Index < mVectorSize; ++Index)
+			referenceCast(mVectorData[Index]).~Type();
+		delete[] mVectorData;
+		mVectorData = NewData.release();
+		mVectorCapacity = NewCapacity;
+
+		// The marks follow their atoms, the new ones start at the old end() mark
+		mVectorSize += Count;
+		NewAtoms[mVectorSize] = { mVectorSize, static_cast<Position>(FirstMarkPos + Count) };
+		mAtomsVector.swap(NewAtoms);
+		mMarksVector.resize(FirstMarkPos + Count + 1);
+		for (auto AtomPos = Position(0); AtomPos <= mVectorSize; ++AtomPos)
+			mMarksVector[mAtomsVector[AtomPos].mMarkPos].mAtomPos = AtomPos;
+		for (NewIndex = 0; NewIndex <= Count; ++NewIndex)
+			mMarksVector[FirstMarkPos + NewIndex].mIteratorID = mIteratorDefaultID;
+		markDirty(0u, mVectorSize);
+
+		// Observers see the same sequence of emplace, in order of position, that would have built the vector
+		if (mObserver)
+			for (NewIndex = 0; NewIndex < Count; ++NewIndex)
+				notifyMutation(TVectorOp::Emplace, mMarksVector[FirstMarkPos + NewIndex].mAtomPos, FirstMarkPos + NewIndex);
+
+		return Count;
+	}
+
 	void init()
 	{
 		// Create a basic pointer for the data
@@ -839,22 +2750,430 @@ private:
 
 		// Create one iterator structure (atom, mark), this is our first iterator, and for now also the end() iterator
 		mAtomsVector.emplace_back(0, 0);
-		mMarksVector.emplace_back(0, 0);
+		mMarksVector.emplace_back(0, mIteratorDefaultID);
+	}
+
+	// Record a written range of the data for consumeDirty()
+	inline void markDirty(const Position& First, const Position& Last) const
+	{
+		if (mDirtyPages)
+			mDirtyPages->mark(First, Last);
+	}
+
+	// Record a data range written in place for publishWrites()
+	inline void recordWrite(const Position& First, const Position& Last) const
+	{
+		if (!mObserver)
+			return;
+
+		if (mWrittenFirst >= mWrittenLast)
+		{
+			mWrittenFirst = First;
+			mWrittenLast = Last;
+			return;
+		}
+
+		mWrittenFirst = First < mWrittenFirst ? First : mWrittenFirst;
+		mWrittenLast = Last > mWrittenLast ? Last : mWrittenLast;
+	}
+
+	// Report a mutation to the observer, the payload is the element at DataIndex when it's a new one
+	inline void notifyMutation(TVectorOp Op, const Position& DataIndex, const Position& MarkPos)
+	{
+		if (!mObserver)
+			return;
+
+		auto NewElement = Op == TVectorOp::EmplaceBack || Op == TVectorOp::Emplace;
+		mObserver->onMutation(Op, DataIndex, MarkPos, mMarksVector[MarkPos].mIteratorID, NewElement ? static_cast<const void*>(mVectorData + DataIndex) : nullptr, NewElement ? sizeof(Type) : 0u);
+	}
+
+	// Apply the mutations recorded by a batch with a single pass over the data, atoms and marks
+	void commitBatch(MutationBatch& Batch)
+	{
+		static_assert(TRelocator<Type>::IsNoexcept, "Batched mutations need elements relocatable without throwing");
+		assert(Batch.mEpoch == mEpoch && "The vector was modified while the batch was open");
+
+		auto& Inserts = Batch.mInserts;
+		auto& Erased = Batch.mErased;
+		if (Inserts.empty() && Erased.empty())
+			return;
+
+		// Order the mutations by position, the inserts at the same position keep the order they were recorded in
+		std::stable_sort(Inserts.begin(), Inserts.end(), [](const typename MutationBatch::Insert& Left, const typename MutationBatch::Insert& Right) { return Left.mIndex < Right.mIndex; });
+		std::sort(Erased.begin(), Erased.end());
+		assert(std::adjacent_find(Erased.begin(), Erased.end()) == Erased.end() && "An element was erased twice in the same batch");
+
+		auto InsertCount = static_cast<Size>(Inserts.size());
+		auto EraseCount = static_cast<Size>(Erased.size());
+		assert(mMarksVector.size() + InsertCount < InvalidPosition && "Too many insertions for the position type, call clear() or optimizeLayout()");
+
+		++mEpoch;
+
+		// The pass reads the whole vector from a single array
+		finishMigration();
+		preserveAll();
+
+		// Allocate everything before touching the vector, so it's unchanged if an allocation throws
+		auto NewSize = static_cast<Size>(mVectorSize - EraseCount + InsertCount);
+		auto NewCapacity = NewSize > mVectorCapacity ? grownCapacity(NewSize) : mVectorCapacity;
+		if (mShrinkDivisor && NewSize < mVectorCapacity / mShrinkDivisor)
+			NewCapacity = std::max<Size>(static_cast<Size>(NewSize * 2u), 1u);
+		std::unique_ptr<Data[]> NewData(new Data[NewCapacity]);
+		std::vector<Atom> NewAtoms(NewSize + 1u);
+		mMarksVector.resize(mMarksVector.size() + InsertCount);
+
+		auto FirstMarkPos = Batch.mFirstMarkPos;
+		auto OldIndex = Size(0);
+		auto NewIndex = Size(0);
+
+		// Relocate the run of old elements up to a position, linking them to their new atoms
+		auto RelocateRun = [&](const Position& Until)
+		{
+			TRelocator<Type>::relocate(NewData.get() + NewIndex, mVectorData + OldIndex, Until - OldIndex);
+			for (; OldIndex < Until; ++OldIndex, ++NewIndex)
+			{
+				auto MarkPos = mAtomsVector[OldIndex].mMarkPos;
+				NewAtoms[NewIndex] = { NewIndex, MarkPos };
+				mMarksVector[MarkPos].mAtomPos = NewIndex;
+			}
+		};
+
+		// Merge the old elements with the recorded mutations
+		auto NextInsert = Size(0);
+		auto NextErase = Size(0);
+		while (NextInsert < InsertCount || NextErase < EraseCount)
+		{
+			auto InsertIndex = NextInsert < InsertCount ? Inserts[NextInsert].mIndex : mVectorSize;
+			auto EraseIndex = NextErase < EraseCount ? Erased[NextErase] : mVectorSize;
+			RelocateRun(InsertIndex < EraseIndex ? InsertIndex : EraseIndex);
+
+			// The new elements go before the old element at their position, each one gets the mark its iterator was given
+			for (; NextInsert < InsertCount && Inserts[NextInsert].mIndex == OldIndex; ++NextInsert, ++NewIndex)
+			{
+				auto Record = Inserts[NextInsert].mRecord;
+				auto MarkPos = static_cast<Position>(FirstMarkPos + Record);
+				TRelocator<Type>::relocate(NewData.get() + NewIndex, Batch.mElements + Record, 1u);
+				NewAtoms[NewIndex] = { NewIndex, MarkPos };
+				mMarksVector[MarkPos] = { NewIndex, mIteratorDefaultID };
+			}
+
+			// Destroy the erased element and invalidate its mark
+			if (NextErase < EraseCount && Erased[NextErase] == OldIndex)
+			{
+				referenceCast(mVectorData[OldIndex]).~Type();
+				++mMarksVector[mAtomsVector[OldIndex].mMarkPos].mIteratorID;
+				++OldIndex;
+				++NextErase;
+			}
+		}
+		RelocateRun(mVectorSize);
+
+		// The end() iterator structure takes the mark after the new elements' ones
+		auto EndMarkPos = static_cast<Position>(FirstMarkPos + InsertCount);
+		NewAtoms[NewSize] = { NewSize, EndMarkPos };
+		mMarksVector[EndMarkPos] = { NewSize, mIteratorDefaultID };
+
+		// Swap in the new arrays, the batch elements have all been relocated
+		delete[] mVectorData;
+		mVectorData = NewData.release();
+		mVectorCapacity = NewCapacity;
+		mVectorSize = NewSize;
+		mAtomsVector.swap(NewAtoms);
+		Batch.mElementCount = 0u;
+
+		// Nothing before the first mutation moved
+		auto FirstChanged = InsertCount ? Inserts.front().mIndex : NewSize;
+		if (EraseCount && Erased.front() < FirstChanged)
+			FirstChanged = Erased.front();
+		markDirty(FirstChanged, NewSize);
+		shrinkIfSparse();
+
+		// Followers receive the result as a whole
+		notifyState();
+	}
+
+	// Report the whole state to the observer
+	void notifyState()
+	{
+		// The state holds the elements written in place too
+		mWrittenFirst = mWrittenLast = 0u;
+
+		if (!mObserver)
+			return;
+
+		// The data must be in a single array
+		finishMigration();
+
+		// The forwarding table goes with the modifications left in its grace period, if it's still in use
+		auto Forwarding = !mForwarding.empty() && mEpoch - mForwardingEpoch <= mForwardingGrace;
+
+		TVectorState State;
+		State.mSize = mVectorSize;
+		State.mDefaultID = mIteratorDefaultID;
+		State.mLayoutBaseID = mLayoutBaseID;
+		State.mForwardingGrace = Forwarding ? mForwardingGrace - (mEpoch - mForwardingEpoch) : 0u;
+		State.mAtoms = mAtomsVector.data();
+		State.mAtomsBytes = mAtomsVector.size() * sizeof(Atom);
+		State.mMarks = mMarksVector.data();
+		State.mMarksBytes = mMarksVector.size() * sizeof(Mark);
+		State.mForwarding = mForwarding.data();
+		State.mForwardingBytes = Forwarding ? mForwarding.size() * sizeof(MarkForward) : 0u;
+		State.mData = mVectorData;
+		State.mDataBytes = mVectorSize * sizeof(Type);
+		mObserver->onState(State);
+	}
+
+	// Construct a specified number of elements at the end of the vector with Construct(Pointer, Index)
+	template<class TConstructor>
+	Iterator appendElements(const Size& Count, TConstructor&& Construct)
+	{
+		/*
+		To append many elements at once:
+		1) Reserve the data array only once
+		2) Construct all the new elements in the uninitialized tail of the data array
+		3) Publish all of them with their iterator structures (atom, mark) in a single step
+		*/
+
+		auto FirstIndex = mVectorSize;
+		if (!Count)
+			return Iterator(FirstIndex, this);
+
+		++mEpoch;
+
+		// Reserve the data array only once
+		if (mVectorSize + Count > mVectorCapacity)
+			growVector(grownCapacity(std::size_t(mVectorSize) + Count));
+
+		// Construct all the new elements, destroying them if one of the constructors throws
+		auto Index = Size(0);
+		try
+		{
+			for (; Index < Count; ++Index)
+				Construct(pointerCast(mVectorData + FirstIndex + Index), Index);
+
+			publishElements(Count);
+		}
+		catch (...)
+		{
+			while (Index > 0)
+				referenceCast(mVectorData[FirstIndex + --Index]).~Type();
+
+			throw;
+		}
+
+		// Return an iterator to the first added element
+		return Iterator(FirstIndex, this);
+	}
+
+	// Make visible a specified number of elements already constructed past the end of the vector
+	void publishElements(const Size& Count)
+	{
+		/*
+		To publish the constructed elements:
+		1) Reserve the iterator structures (atom, mark) only once
+		2) Link the elements to the atoms/marks in a single pass, the old end() iterator structure belongs to the first new element
+		3) Create a new end() iterator
+		4) Increase the vector size
+		*/
+
+		auto FirstIndex = mVectorSize;
+		auto FirstMarkPos = static_cast<Position>(mMarksVector.size() - 1);
+
+		// Keep for the snapshots the end() iterator structure that's about to change
+		preserveTableGrowth(Count);
+		preserveAtoms(FirstIndex, FirstIndex + 1);
+		preserveMarks(FirstMarkPos, FirstMarkPos + 1);
+
+		// Reserve the iterator structures (atom, mark) only once
+		mAtomsVector.resize(mVectorSize + Count + 1);
+		try
+		{
+			mMarksVector.resize(FirstMarkPos + Count + 1);
+		}
+		catch (...)
+		{
+			mAtomsVector.resize(mVectorSize + 1);
+			throw;
+		}
+
+		// Link the elements to the atoms/marks, the last iteration creates the new end() iterator
+		auto Atoms = mAtomsVector.data() + FirstIndex;
+		auto Marks = mMarksVector.data() + FirstMarkPos;
+		for (auto Index = Size(0); Index <= Count; ++Index)
+		{
+			Atoms[Index] = { static_cast<Position>(FirstIndex + Index), static_cast<Position>(FirstMarkPos + Index) };
+			Marks[Index] = { static_cast<Position>(FirstIndex + Index), mIteratorDefaultID };
+		}
+
+		// Increase the vector size
+		mVectorSize += Count;
+		markDirty(FirstIndex, mVectorSize);
+
+		// Observers see the same sequence of emplaceBack that would have built the vector
+		if (mObserver)
+			for (auto Index = Size(0); Index < Count; ++Index)
+				notifyMutation(TVectorOp::EmplaceBack, FirstIndex + Index, FirstMarkPos + Index);
+	}
+
+	// Get the storage of an element, looking in the old array if it hasn't been migrated yet
+	inline Data& getData(const Position& Index) const
+	{
+		if (mOldVectorData && Index >= mMigratedCount && Index < mMigrationEnd)
+			return mOldVectorData[Index];
+
+		return mVectorData[Index];
+	}
+
+	// Get the storage of an element that is about to be written
+	inline Data& getWritableData(const Position& Index) const
+	{
+		preserveData(Index, Index + 1);
+		markDirty(Index, Index + 1);
+		recordWrite(Index, Index + 1);
+
+		return getData(Index);
+	}
+
+	// Let every snapshot still reading the live vector copy a part of it, then forget the ones that don't need us anymore
+	template<class TPreserve>
+	void preserveSnapshots(TPreserve&& Preserve) const
+	{
+		for (auto Index = std::size_t(0); Index < mSnapshots.size();)
+		{
+			auto State = mSnapshots[Index].lock();
+			if (State)
+			{
+				// Whoever is reading the old content must be done before it changes
+				if (Preserve(*State))
+					State->waitLiveReaders();
+
+				if (!State->isDetached())
+				{
+					++Index;
+					continue;
+				}
+			}
+
+			mSnapshots[Index] = std::move(mSnapshots.back());
+			mSnapshots.pop_back();
+		}
+	}
+
+	// Preserve a range of the data, atoms or marks for the snapshots
+	inline void preserveData(const Position& First, const Position& Last) const
+	{
+		if (!mSnapshots.empty())
+			preserveSnapshots([First, Last](SnapshotState& State) { return State.mData.preserve(First, Last); });
+	}
+	inline void preserveAtoms(const Position& First, const Position& Last) const
+	{
+		if (!mSnapshots.empty())
+			preserveSnapshots([First, Last](SnapshotState& State) { return State.mAtoms.preserve(First, Last); });
+	}
+	inline void preserveMarks(const Position& First, const Position& Last) const
+	{
+		if (!mSnapshots.empty())
+			preserveSnapshots([First, Last](SnapshotState& State) { return State.mMarks.preserve(First, Last); });
+	}
+
+	// Preserve everything, before the live vector releases or rewrites its arrays
+	void preserveAll() const
+	{
+		if (!mSnapshots.empty())
+			preserveSnapshots([](SnapshotState& State)
+			{
+				auto Copied = State.mData.preserve(0u, State.mData.mCount);
+				Copied |= State.mAtoms.preserve(0u, State.mAtoms.mCount);
+				Copied |= State.mMarks.preserve(0u, State.mMarks.mCount);
+				return Copied;
+			});
+	}
+
+	// Preserve the iterator structures (atom, mark) if adding some more would reallocate them
+	// Every growth of the tables goes through here, so it also checks the marks are still addressable by a Position
+	void preserveTableGrowth(const Size& Extra) const
+	{
+		assert(mMarksVector.size() + Extra < InvalidPosition && "Too many insertions for the position type, call clear() or optimizeLayout()");
+
+		if (mAtomsVector.size() + Extra > mAtomsVector.capacity())
+			preserveAtoms(0u, static_cast<Position>(mAtomsVector.size()));
+		if (mMarksVector.size() + Extra > mMarksVector.capacity())
+			preserveMarks(0u, static_cast<Position>(mMarksVector.size()));
+	}
+
+	// Allocate a bigger array and keep the old one around, its elements will be moved by later operations
+	void beginMigration(const Size& NewCapacity)
+	{
+		// Only one old array at a time
+		finishMigration();
+
+		// The elements are leaving the array the snapshots read
+		preserveData(0u, mVectorSize);
+
+		mOldVectorData = mVectorData;
+		mMigratedCount = 0u;
+		mMigrationEnd = mVectorSize;
+
+		// Assign the new array to the vector data
+		mVectorData = new Data[NewCapacity];
+		mVectorCapacity = NewCapacity;
+	}
+
+	// Move up to a specific amount of elements from the old array to the new one
+	void migrateElements(const Size& Count)
+	{
+		auto Remaining = static_cast<Size>(mMigrationEnd - mMigratedCount);
+		auto Batch = Count < Remaining ? Count : Remaining;
+		TRelocator<Type>::relocate(mVectorData + mMigratedCount, mOldVectorData + mMigratedCount, Batch);
+		mMigratedCount += Batch;
+
+		// Release the old array once it's empty
+		if (mMigratedCount == mMigrationEnd)
+		{
+			delete[] mOldVectorData;
+			mOldVectorData = nullptr;
+			mMigratedCount = mMigrationEnd = 0u;
+		}
+	}
+
+	// Move all the remaining elements from the old array to the new one
+	void finishMigration()
+	{
+		if (mOldVectorData)
+			migrateElements(mMigrationEnd);
+	}
+
+	// Returns the capacity to grow to so Required elements fit, doubling but never past max_size()
+	Size grownCapacity(std::size_t Required) const
+	{
+		assert(Required <= max_size() && "The position type can't index that many elements");
+
+		auto Doubled = std::max<std::size_t>(std::size_t(mVectorCapacity) * 2u, Required);
+		return static_cast<Size>(std::min<std::size_t>(Doubled, max_size()));
 	}
 
 	// Grow the vector by a specific amount
 	void growVector(const Size& NewCapacity)
 	{
+		// Complete any pending migration before reallocating
+		finishMigration();
+
+		// The elements are leaving the array the snapshots read
+		preserveData(0u, mVectorSize);
+
 		// Create a new temp array
 		Data* TempArray = new Data[NewCapacity];
 
-		// Move the old array in the new array
-		for (auto Index = 0u; Index < mVectorSize; ++Index)
-			new(TempArray + Index) Type(std::move(referenceCast(mVectorData[Index])));
-
-		// Delete the old data
-		for (auto Index = 0u; Index < mVectorSize; ++Index)
-			referenceCast(mVectorData[Index]).~Type();
+		// Relocate the old array in the new array
+		try
+		{
+			TParallelRelocator<Type>::relocate(TempArray, mVectorData, mVectorSize, mParallelRelocation.get());
+		}
+		catch (...)
+		{
+			delete[] TempArray;
+			throw;
+		}
 
 		delete[] mVectorData;
 
@@ -865,13 +3184,58 @@ private:
 		mVectorCapacity = NewCapacity;
 	}
 
+	// Apply the shrink policy after a removal
+	// Shrinking is only an optimization, the vector keeps its storage if it can't allocate the smaller one
+	void shrinkIfSparse() noexcept
+	{
+		if (!mShrinkDivisor)
+			return;
+
+		try
+		{
+			if (mVectorSize < mVectorCapacity / mShrinkDivisor)
+				growVector(std::max<Size>(static_cast<Size>(mVectorSize * 2u), 1u));
+
+			shrinkTables(mShrinkDivisor, 2u);
+		}
+		catch (...)
+		{
+		}
+	}
+
+	// Reallocate the atom and mark tables to Factor times their size, the ones with more than Divisor times it
+	void shrinkTables(const std::size_t& Divisor, const std::size_t& Factor)
+	{
+		if (mAtomsVector.capacity() > mAtomsVector.size() * Divisor)
+		{
+			preserveAtoms(0u, static_cast<Position>(mAtomsVector.size()));
+			trimTable(mAtomsVector, mAtomsVector.size() * Factor);
+		}
+
+		if (mMarksVector.capacity() > mMarksVector.size() * Divisor)
+		{
+			preserveMarks(0u, static_cast<Position>(mMarksVector.size()));
+			trimTable(mMarksVector, mMarksVector.size() * Factor);
+		}
+	}
+
+	// Copy a table to an allocation of a specific capacity
+	template <class TTable>
+	static void trimTable(TTable& Table, const std::size_t& Capacity)
+	{
+		TTable Trimmed;
+		Trimmed.reserve(Capacity);
+		Trimmed.assign(Table.begin(), Table.end());
+		Table.swap(Trimmed);
+	}
+
 	// Shift atoms to the right
 	void shiftAtomVectorRight(const Position& StartPosition)
 	{
 		// Right shift the atoms
-		auto& EndOfShift = mAtomsVector.rbegin();
-		auto& BeginOfShift = EndOfShift + (mVectorSize - StartPosition);
-		for (auto& RightAtom = EndOfShift, LeftAtom = EndOfShift + 1; RightAtom != BeginOfShift; ++RightAtom, ++LeftAtom)
+		auto EndOfShift = mAtomsVector.rbegin();
+		auto BeginOfShift = EndOfShift + (mVectorSize - StartPosition);
+		for (auto RightAtom = EndOfShift, LeftAtom = EndOfShift + 1; RightAtom != BeginOfShift; ++RightAtom, ++LeftAtom)
 		{
 			RightAtom->mMarkPos = LeftAtom->mMarkPos;
 			RightAtom->mDataPos = LeftAtom->mDataPos + 1;
@@ -881,31 +3245,35 @@ private:
 	// Shift marks to the right
 	void shiftMarkVectorRight(const Position& StartPosition)
 	{
-		auto NumberOfMarks = mMarksVector.size();
-		for (auto Index = StartPosition + 1; Index < NumberOfMarks; ++Index)
+		auto NumberOfAtoms = mAtomsVector.size();
+		for (auto Index = std::size_t(StartPosition) + 1; Index < NumberOfAtoms; ++Index)
 			++getMarkFromAtom(mAtomsVector[Index]).mAtomPos;
 	}
 
-	// Shift array to the right from a starting position for a specified number of elements
+	// Shift array to the right from a starting position for a specified number of elements, leaving a gap of uninitialized storage
 	void shiftArrayRight(const Position& StartPosition, const Size& NoOfElement)
 	{
-		// Right shift start
-		auto EndOfShift = (mVectorSize + NoOfElement) - 1;
-
-		// Left shift start
-		auto BeginOfShift = mVectorSize - 1;
-
-		// Right shift the data to the right
-		for (auto RightIndex = EndOfShift, LeftIndex = BeginOfShift, Counter = mVectorSize; Counter > StartPosition; --RightIndex, --LeftIndex, --Counter)
-			std::memcpy(mVectorData + RightIndex, mVectorData + LeftIndex, sizeof(Data));
-		//mVectorData[RightIndex] = std::move(mVectorData[LeftIndex]);
+		TParallelRelocator<Type>::relocateRight(mVectorData + StartPosition + NoOfElement, mVectorData + StartPosition, mVectorSize - StartPosition, mParallelRelocation.get());
 	}
 
-	// Shift array to the right from a starting position for a specified number of elements
+	// Shift array to the left from a starting position for a specified number of elements, the elements it covers must be destroyed already
 	void shiftArrayLeft(const Position& StartPosition, const Size& NoOfElement)
 	{
-		for (auto LeftIndex = StartPosition, RightIndex = StartPosition + NoOfElement; RightIndex < mVectorSize; ++LeftIndex, ++RightIndex)
-			std::memcpy(mVectorData + LeftIndex, mVectorData + RightIndex, sizeof(Data));
+		if (StartPosition + NoOfElement < mVectorSize)
+			TParallelRelocator<Type>::relocateLeft(mVectorData + StartPosition, mVectorData + StartPosition + NoOfElement, mVectorSize - StartPosition - NoOfElement, mParallelRelocation.get());
+	}
+
+	// Shift the elements from Read on down to Write, along with their atoms, after the elements in between were removed
+	void closeGap(const Position& Write, const Position& Read)
+	{
+		auto Removed = static_cast<Size>(Read - Write);
+		if (!Removed)
+			return;
+
+		shiftArrayLeft(Write, Removed);
+		shiftAtomVectorLeft(Write, Removed);
+		mAtomsVector.resize(mAtomsVector.size() - Removed);
+		mVectorSize -= Removed;
 	}
 
 	// Shift the atom array to the left
@@ -914,7 +3282,7 @@ private:
 		auto EndOfShift = mAtomsVector.size();
 
 		// Shift the atoms vector to the left by a specified amount
-		for (auto LeftIndex = StartPosition, RightIndex = StartPosition + NoOfElement; RightIndex < EndOfShift; ++LeftIndex, ++RightIndex)
+		for (auto LeftIndex = std::size_t(StartPosition), RightIndex = std::size_t(StartPosition) + NoOfElement; RightIndex < EndOfShift; ++LeftIndex, ++RightIndex)
 		{
 			// Copy the content of X + 1 -> X
 			mAtomsVector[LeftIndex] = mAtomsVector[RightIndex];
@@ -927,13 +3295,53 @@ private:
 		}
 	}
 
-	Mark& getMarkFromIterator(const Iterator& SourceIterator)
+	template <bool TConstness>
+	Mark& getMarkFromIterator(const TIterator<TConstness>& SourceIterator)
 	{
-		return mMarksVector[SourceIterator.mMarkPos];
+		return mMarksVector[getMarkPos(SourceIterator)];
 	}
-	const Mark& getMarkFromIterator(const Iterator& SourceIterator) const
+	template <bool TConstness>
+	const Mark& getMarkFromIterator(const TIterator<TConstness>& SourceIterator) const
 	{
-		return mMarksVector[SourceIterator.mMarkPos];
+		return mMarksVector[getMarkPos(SourceIterator)];
+	}
+
+	// Get the position of the mark of an iterator, the ones created before the last optimizeLayout() go through the forwarding table
+	template <bool TConstness>
+	inline Position getMarkPos(const TIterator<TConstness>& SourceIterator) const
+	{
+		if (SourceIterator.mIteratorID >= mLayoutBaseID)
+			return SourceIterator.mMarkPos;
+
+		// The ones that can't be forwarded anymore behave like end()
+		auto MarkPos = forwardMarkPos(SourceIterator);
+		return MarkPos != InvalidPosition ? MarkPos : static_cast<Position>(mMarksVector.size() - 1);
+	}
+
+	// Find the new mark of an iterator created before the last optimizeLayout()
+	template <bool TConstness>
+	Position forwardMarkPos(const TIterator<TConstness>& SourceIterator) const
+	{
+		if (SourceIterator.mMarkPos < mForwarding.size() && mEpoch - mForwardingEpoch <= mForwardingGrace)
+		{
+			auto& Forward = mForwarding[SourceIterator.mMarkPos];
+			if (Forward.mMarkPos != InvalidPosition && Forward.mIteratorID == SourceIterator.mIteratorID)
+				return Forward.mMarkPos;
+		}
+
+		return InvalidPosition;
+	}
+
+	// Check if an iterator still points to an element (or to the end)
+	template <bool TConstness>
+	inline bool isIteratorValid(const TIterator<TConstness>& SourceIterator) const
+	{
+		if (SourceIterator.mIteratorID >= mLayoutBaseID)
+			return SourceIterator.mMarkPos < mMarksVector.size() && mMarksVector[SourceIterator.mMarkPos].mIteratorID == SourceIterator.mIteratorID;
+
+		// The marks kept by optimizeLayout() all got the base ID, an erase changed it
+		auto MarkPos = forwardMarkPos(SourceIterator);
+		return MarkPos != InvalidPosition && mMarksVector[MarkPos].mIteratorID == mLayoutBaseID;
 	}
 
 	// Atom/Mark exchange
@@ -947,18 +3355,59 @@ private:
 	}
 
 	// Get the actual position in the data array from an iterator
-	const Position& getDataIndexFromIterator(const Iterator& SourceIterator) const
+	template <bool TConstness>
+	const Position& getDataIndexFromIterator(const TIterator<TConstness>& SourceIterator) const
 	{
 		return mAtomsVector[getMarkFromIterator(SourceIterator).mAtomPos].mDataPos;
 	}
 
 private:
 	Data*	mVectorData;
+	Data*	mOldVectorData;
+	Size	mMigratedCount;
+	Size	mMigrationEnd;
+	Size	mMigrationBudget;
+
+	// Removals shrink the storage once the size falls below capacity / mShrinkDivisor, 0 never
+	Size	mShrinkDivisor;
+
+	// Shared by the copies of the vector, null if the relocations are serial
+	std::shared_ptr<const TParallelRelocation>	mParallelRelocation;
+
 	Size	mVectorSize;
 	Size	mVectorCapacity;
-	Position	mIteratorDefaultID;
+	TID		mIteratorDefaultID;
+
+	// Modification counter, cached iterators compare it to know if their data position is still right
+	std::uint64_t	mEpoch;
+
+	// Receives all the mutations, if any
+	TVectorObserver*	mObserver;
+
+	// Data range written in place since the last publishWrites(), only recorded while there's an observer
+	mutable Position	mWrittenFirst;
+	mutable Position	mWrittenLast;
+
+	// Pages written since the last consumeDirty(), null if the tracking is off
+	std::unique_ptr<TVectorDirtyPages>	mDirtyPages;
+
+	// Snapshots that still read parts of the live vector
+	mutable std::vector<std::weak_ptr<SnapshotState>>	mSnapshots;
+
+	// Iterators with a lower ID were created before the last optimizeLayout(), they are forwarded for a grace number of modifications
+	TID							mLayoutBaseID;
+	std::vector<MarkForward>	mForwarding;
+	std::uint64_t				mForwardingEpoch;
+	std::uint64_t				mForwardingGrace;
 
 	// 
 	std::vector<Atom>	mAtomsVector;
 	std::vector<Mark>	mMarksVector;
 };
+
+// Exchanges the contents of two vectors
+template <class Type, class TPosition, class TID>
+void swap(TVector<Type, TPosition, TID>& Left, TVector<Type, TPosition, TID>& Right) noexcept
+{
+	Left.swap(Right);
+}
@@ -0,0 +1,426 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#include <functional>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Type of the key KeyFn extracts from an element
+template <class Type, class KeyFn>
+using TVectorKey = std::decay_t<decltype(std::declval<KeyFn&>()(std::declval<const Type&>()))>;
+
+// A TVector with a hash index from a key of the elements to their marks, kept up to date by every modification
+// Marks don't move when the elements are shifted, so the index is only touched by the inserted and removed elements
+// The keys must be unique and must not be changed through the iterators
+template <class Type, class KeyFn, class Hash = std::hash<TVectorKey<Type, KeyFn>>, class KeyEqual = std::equal_to<TVectorKey<Type, KeyFn>>>
+class TVectorIndexed
+{
+public:
+
+	// Type aliases
+	using Vector = TVector<Type>;
+	using Iterator = typename Vector::Iterator;
+	using CIterator = typename Vector::CIterator;
+	using CReference = typename Vector::CReference;
+	using CPointer = typename Vector::CPointer;
+	using Position = typename Vector::Position;
+	using Size = typename Vector::Size;
+	using Key = TVectorKey<Type, KeyFn>;
+
+	// Default constructor
+	TVectorIndexed(const KeyFn& GetKey = KeyFn(), const Hash& Hasher = Hash(), const KeyEqual& Equal = KeyEqual()) :
+		mGetKey(GetKey),
+		mHash(Hasher),
+		mEqual(Equal),
+		mIndexSize(0u),
+		mDeleted(0u)
+	{
+	}
+
+#pragma region Element access
+
+	// Access specified element
+	CReference operator[](const Size& Index) const
+	{
+		return mVector[Index];
+	}
+
+	// Direct access to the underlying array
+	CPointer data() const
+	{
+		return mVector.data();
+	}
+
+	// Access the underlying vector
+	const Vector& vector() const noexcept
+	{
+		return mVector;
+	}
+
+#pragma endregion
+
+#pragma region Iterators
+
+	Iterator begin()
+	{
+		return mVector.begin();
+	}
+	CIterator begin() const
+	{
+		return mVector.begin();
+	}
+
+	Iterator end()
+	{
+		return mVector.end();
+	}
+	CIterator end() const
+	{
+		return mVector.end();
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Checks whether the container is empty
+	bool empty() const noexcept
+	{
+		return !mVector.size();
+	}
+
+	// Returns the number of elements
+	const Size& size() const noexcept
+	{
+		return mVector.size();
+	}
+
+	// Reserves storage for the elements and their index entries
+	void reserve(const Size& NewCapacity)
+	{
+		mVector.reserve(NewCapacity);
+
+		if (NewCapacity > maxIndexSize())
+			rehash(NewCapacity);
+	}
+
+#pragma endregion
+
+#pragma region Lookup
+
+	// Returns an iterator to the element with the key, or end()
+	Iterator find(const Key& Value)
+	{
+		auto SlotIndex = findSlot(Value, hashKey(Value));
+		if (SlotIndex == NoSlot)
+			return mVector.end();
+
+		return Iterator(mSlots[SlotIndex].mMarkPos, mSlots[SlotIndex].mID, &mVector);
+	}
+
+	// Checks whether an element has the key
+	bool contains(const Key& Value) const
+	{
+		return findSlot(Value, hashKey(Value)) != NoSlot;
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Constructs an element at the end and indexes it
+	template <class... TArgs>
+	Iterator emplaceBack(TArgs&&... Args)
+	{
+		return indexElement(mVector.emplaceBack(std::forward<TArgs>(Args)...));
+	}
+	Iterator pushBack(const Type& Value)
+	{
+		return emplaceBack(Value);
+	}
+	Iterator pushBack(Type&& Value)
+	{
+		return emplaceBack(std::move(Value));
+	}
+
+	// Constructs an element before InsertPosition and indexes it
+	template <class... TArgs>
+	Iterator emplace(const CIterator& InsertPosition, TArgs&&... Args)
+	{
+		return indexElement(mVector.emplace(InsertPosition, std::forward<TArgs>(Args)...));
+	}
+
+	// Removes specified element from the container and the index
+	Iterator erase(const CIterator& DeletePosition)
+	{
+		if (DeletePosition == mVector.end())
+			return mVector.end();
+
+		auto Value = mGetKey(*DeletePosition);
+		removeSlot(findSlot(Value, hashKey(Value)));
+
+		return mVector.erase(DeletePosition);
+	}
+
+	// Removes the element with the key, returns false if there was none
+	bool eraseKey(const Key& Value)
+	{
+		auto SlotIndex = findSlot(Value, hashKey(Value));
+		if (SlotIndex == NoSlot)
+			return false;
+
+		Iterator DeletePosition(mSlots[SlotIndex].mMarkPos, mSlots[SlotIndex].mID, &mVector);
+		removeSlot(SlotIndex);
+		mVector.erase(DeletePosition);
+
+		return true;
+	}
+
+	// Removes the last element
+	void popBack()
+	{
+		auto Value = mGetKey(mVector.back());
+		removeSlot(findSlot(Value, hashKey(Value)));
+
+		mVector.popBack();
+	}
+
+	// Clears the contents, the index keeps its memory
+	void clear()
+	{
+		mVector.clear();
+
+		std::fill(mControl.begin(), mControl.end(), std::int8_t(Empty));
+		mIndexSize = mDeleted = 0u;
+	}
+
+#pragma endregion
+
+private:
+
+	// Control byte of a slot, the used ones hold 7 bits of the key hash
+	static constexpr std::int8_t Empty = -128;
+	static constexpr std::int8_t Deleted = -2;
+
+	// The slots are probed 16 at a time, one SSE2 comparison per group
+	static constexpr std::size_t GroupSize = 16u;
+	static constexpr std::size_t NoSlot = std::size_t(-1);
+
+	// A key and the identity of the element it belongs to
+	struct Entry
+	{
+		Key						mKey;
+		Position				mMarkPos;
+		typename Iterator::ID	mID;
+	};
+
+	// Mix the key hash, so weak hashes (like the identity hash of integers) spread over the groups and the control bytes
+	std::size_t hashKey(const Key& Value) const
+	{
+		auto Mixed = static_cast<std::uint64_t>(mHash(Value)) * 0x9E3779B97F4A7C15ull;
+		return static_cast<std::size_t>(Mixed ^ (Mixed >> 32));
+	}
+
+	// The 7 bits of the hash stored in the control byte
+	static std::int8_t controlOf(std::size_t HashValue)
+	{
+		return static_cast<std::int8_t>(HashValue & 0x7Fu);
+	}
+
+	// The first group to probe
+	std::size_t firstGroup(std::size_t HashValue) const
+	{
+		return (HashValue >> 7) & (groupCount() - 1u);
+	}
+
+	std::size_t groupCount() const
+	{
+		return mControl.size() / GroupSize;
+	}
+
+	// The index is rebuilt bigger once 7/8 of the slots are used or deleted
+	std::size_t maxIndexSize() const
+	{
+		return mControl.size() / 8u * 7u;
+	}
+
+	// Bit mask of the slots of a group with the control byte
+	std::uint32_t matchGroup(std::size_t Group, std::int8_t Control) const
+	{
+		auto Bytes = mControl.data() + Group * GroupSize;
+#ifdef TVECTOR_SSE2
+		auto Controls = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Bytes));
+		return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Controls, _mm_set1_epi8(Control))));
+#else
+		auto Mask = std::uint32_t(0);
+		for (auto Index = 0u; Index < GroupSize; ++Index)
+			Mask |= std::uint32_t(Bytes[Index] == Control) << Index;
+		return Mask;
+#endif
+	}
+
+	// Index of the lowest set bit of a non zero mask
+	static unsigned int lowestBit(std::uint32_t Mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long Bit;
+		_BitScanForward(&Bit, Mask);
+		return static_cast<unsigned int>(Bit);
+#elif defined(__GNUC__)
+		return static_cast<unsigned int>(__builtin_ctz(Mask));
+#else
+		auto Bit = 0u;
+		while (!(Mask & 1u))
+		{
+			Mask >>= 1;
+			++Bit;
+		}
+		return Bit;
+#endif
+	}
+
+	// Returns the slot holding the key, or NoSlot
+	// The groups are probed in triangular order, which visits all of them when their number is a power of 2
+	std::size_t findSlot(const Key& Value, std::size_t HashValue) const
+	{
+		if (mControl.empty())
+			return NoSlot;
+
+		auto Control = controlOf(HashValue);
+		auto Group = firstGroup(HashValue);
+		for (auto Probe = std::size_t(0); Probe < groupCount(); Group = (Group + ++Probe) & (groupCount() - 1u))
+		{
+			// Compare the keys of the slots with the same control byte
+			for (auto Matches = matchGroup(Group, Control); Matches; Matches &= Matches - 1u)
+			{
+				auto SlotIndex = Group * GroupSize + lowestBit(Matches);
+				if (mEqual(mSlots[SlotIndex].mKey, Value))
+					return SlotIndex;
+			}
+
+			// An empty slot ends the probe sequence
+			if (matchGroup(Group, Empty))
+				return NoSlot;
+		}
+
+		return NoSlot;
+	}
+
+	// Put a key in the first empty or deleted slot of its probe sequence, the index must have room for it
+	void insertSlot(Key&& Value, std::size_t HashValue, const Iterator& Element)
+	{
+		auto Group = firstGroup(HashValue);
+		for (auto Probe = std::size_t(0);; Group = (Group + ++Probe) & (groupCount() - 1u))
+		{
+			auto Free = matchGroup(Group, Empty) | matchGroup(Group, Deleted);
+			if (!Free)
+				continue;
+
+			auto SlotIndex = Group * GroupSize + lowestBit(Free);
+			if (mControl[SlotIndex] == Deleted)
+				--mDeleted;
+
+			mControl[SlotIndex] = controlOf(HashValue);
+			mSlots[SlotIndex] = { std::move(Value), Element.markPos(), Element.id() };
+			++mIndexSize;
+			return;
+		}
+	}
+
+	// Mark a slot as deleted, the probe sequences going through it must continue
+	void removeSlot(std::size_t SlotIndex)
+	{
+		assert(SlotIndex != NoSlot && "The key of the element was changed after it was inserted");
+
+		mControl[SlotIndex] = Deleted;
+		mSlots[SlotIndex] = Entry();
+		--mIndexSize;
+		++mDeleted;
+	}
+
+	// Index a new element, it's removed again if the index can't grow
+	Iterator indexElement(const Iterator& Element)
+	{
+		try
+		{
+			auto Value = mGetKey(*Element);
+			auto HashValue = hashKey(Value);
+			assert(findSlot(Value, HashValue) == NoSlot && "The keys must be unique");
+
+			// Double the index when it's full, or just drop the deleted slots if they are most of it
+			if (mIndexSize + mDeleted + 1u > maxIndexSize())
+				rehash((mIndexSize + 1u) * 2u);
+
+			insertSlot(std::move(Value), HashValue, Element);
+		}
+		catch (...)
+		{
+			mVector.erase(Element);
+			throw;
+		}
+
+		return Element;
+	}
+
+	// Rebuild the index with room for a number of keys, dropping the deleted slots
+	void rehash(std::size_t MinSize)
+	{
+		auto Capacity = GroupSize;
+		while (Capacity / 8u * 7u < MinSize)
+			Capacity *= 2u;
+
+		std::vector<std::int8_t> OldControl(Capacity, std::int8_t(Empty));
+		std::vector<Entry> OldSlots(Capacity);
+		OldControl.swap(mControl);
+		OldSlots.swap(mSlots);
+		mIndexSize = mDeleted = 0u;
+
+		// Move the keys to their new slots
+		for (auto Index = std::size_t(0); Index < OldControl.size(); ++Index)
+		{
+			if (OldControl[Index] < 0)
+				continue;
+
+			auto& Old = OldSlots[Index];
+			auto HashValue = hashKey(Old.mKey);
+			insertSlot(std::move(Old.mKey), HashValue, Iterator(Old.mMarkPos, Old.mID, &mVector));
+		}
+	}
+
+private:
+	Vector		mVector;
+	KeyFn		mGetKey;
+	Hash		mHash;
+	KeyEqual	mEqual;
+
+	// Flat hash index, the control bytes of the slots are stored apart so a group is probed with a single load
+	std::vector<std::int8_t>	mControl;
+	std::vector<Entry>			mSlots;
+	std::size_t					mIndexSize;
+	std::size_t					mDeleted;
+};
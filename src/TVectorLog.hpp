@@ -0,0 +1,447 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <system_error>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TVECTOR_LOG_SHARED_MEMORY
+#endif
+
+// A compact record of a single mutation, followed in the log by PayloadSize bytes of payload
+struct MutationRecord
+{
+	// Extra operations used to send the whole vector state, split in chunks
+	static constexpr std::uint8_t StateBegin = 0x10;
+	static constexpr std::uint8_t StateChunk = 0x11;
+
+	std::uint8_t	mOp;
+	std::uint8_t	mPadding[3];
+	std::uint32_t	mPayloadSize;
+	// 64 bit so vectors with any position type can be logged
+	std::uint64_t	mDataIndex;
+	std::uint64_t	mMarkPos;
+	std::uint64_t	mGeneration;
+};
+
+// Payload of a StateBegin record, the chunks that follow hold the atoms, the marks, the forwarding table and the data one after the other
+struct MutationStateHeader
+{
+	std::uint64_t	mSize;
+	std::uint64_t	mDefaultID;
+	std::uint64_t	mLayoutBaseID;
+	std::uint64_t	mForwardingGrace;
+	std::uint64_t	mAtomsBytes;
+	std::uint64_t	mMarksBytes;
+	std::uint64_t	mForwardingBytes;
+	std::uint64_t	mDataBytes;
+};
+
+// Single producer/single consumer ring buffer of mutation records
+// It can live in the heap, or in a shared file/memfd mapping so a follower process can replay the mutations of a primary one
+class MutationLog : public TVectorObserver
+{
+public:
+
+	// Create a log in the heap, for a follower in the same process
+	explicit MutationLog(std::size_t Capacity) :
+		mHeader(nullptr),
+		mBuffer(nullptr),
+		mMappedBytes(0u),
+		mWriteTimeout(std::chrono::seconds(1))
+	{
+		auto Memory = new char[sizeof(SharedHeader) + Capacity];
+		initialize(Memory, Capacity, true);
+	}
+
+#ifdef TVECTOR_LOG_SHARED_MEMORY
+	// Map a log stored in a file, the primary creates it and the follower opens it with Create = false
+	MutationLog(const char* Path, std::size_t Capacity, bool Create) :
+		mHeader(nullptr),
+		mBuffer(nullptr),
+		mMappedBytes(0u),
+		mWriteTimeout(std::chrono::seconds(1))
+	{
+		auto FileDescriptor = ::open(Path, Create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0600);
+		if (FileDescriptor < 0)
+			throw std::system_error(errno, std::generic_category(), "MutationLog: can't open the log file");
+
+		try
+		{
+			map(FileDescriptor, Capacity, Create);
+		}
+		catch (...)
+		{
+			::close(FileDescriptor);
+			throw;
+		}
+
+		// The mapping keeps the file alive
+		::close(FileDescriptor);
+	}
+
+	// Map a log stored in an already open file descriptor (e.g. one created with memfd_create and passed to the follower)
+	MutationLog(int FileDescriptor, std::size_t Capacity, bool Create) :
+		mHeader(nullptr),
+		mBuffer(nullptr),
+		mMappedBytes(0u),
+		mWriteTimeout(std::chrono::seconds(1))
+	{
+		map(FileDescriptor, Capacity, Create);
+	}
+#endif
+
+	MutationLog(const MutationLog&) = delete;
+	MutationLog& operator=(const MutationLog&) = delete;
+
+	~MutationLog()
+	{
+#ifdef TVECTOR_LOG_SHARED_MEMORY
+		if (mMappedBytes)
+		{
+			::munmap(mHeader, mMappedBytes);
+			return;
+		}
+#endif
+		delete[] reinterpret_cast<char*>(mHeader);
+	}
+
+	// Append a record, waiting up to the write timeout for the follower to make room if the log is full
+	// A follower in the same thread needs a log big enough for what it replays at once
+	// Returns false if the follower didn't make room in time, the log is then overflowed and drops every record from now on
+	bool write(const MutationRecord& Record, const void* Payload)
+	{
+		// A record that can never fit is a log too small for the vector it observes
+		auto RecordBytes = sizeof(MutationRecord) + Record.mPayloadSize;
+		assert(RecordBytes <= mHeader->mCapacity && "MutationLog: the record is bigger than the whole log");
+		if (RecordBytes > mHeader->mCapacity || overflowed())
+			return setOverflowed();
+
+		// Wait for the follower to consume enough records
+		auto Head = mHeader->mHead.load(std::memory_order_relaxed);
+		if (!hasRoom(Head, RecordBytes))
+		{
+			auto Deadline = std::chrono::steady_clock::now() + mWriteTimeout;
+			while (!hasRoom(Head, RecordBytes))
+			{
+				if (std::chrono::steady_clock::now() >= Deadline)
+					return setOverflowed();
+
+				std::this_thread::yield();
+			}
+		}
+
+		copyIn(Head, &Record, sizeof(MutationRecord));
+		copyIn(Head + sizeof(MutationRecord), Payload, Record.mPayloadSize);
+
+		// Publish the record
+		mHeader->mHead.store(Head + RecordBytes, std::memory_order_release);
+
+		return true;
+	}
+
+	// Take the oldest record out of the log, returns false if the log is empty
+	bool read(MutationRecord& Record, std::vector<char>& Payload)
+	{
+		auto Tail = mHeader->mTail.load(std::memory_order_relaxed);
+		if (Tail == mHeader->mHead.load(std::memory_order_acquire))
+			return false;
+
+		copyOut(Tail, &Record, sizeof(MutationRecord));
+		Payload.resize(Record.mPayloadSize);
+		copyOut(Tail + sizeof(MutationRecord), Payload.data(), Record.mPayloadSize);
+
+		// Give the room back to the primary
+		mHeader->mTail.store(Tail + sizeof(MutationRecord) + Record.mPayloadSize, std::memory_order_release);
+
+		return true;
+	}
+
+	// Number of bytes waiting to be read
+	std::size_t pendingBytes() const
+	{
+		return static_cast<std::size_t>(mHeader->mHead.load(std::memory_order_acquire) - mHeader->mTail.load(std::memory_order_acquire));
+	}
+
+	// Sets how long write() waits for the follower to make room before giving up
+	void setWriteTimeout(std::chrono::nanoseconds Timeout) noexcept
+	{
+		mWriteTimeout = Timeout;
+	}
+
+	// Checks whether a record was dropped, the follower then can't replay the primary anymore and has to start over from a new log
+	bool overflowed() const noexcept
+	{
+		return mHeader->mOverflowed.load(std::memory_order_acquire) != 0u;
+	}
+
+	void onMutation(TVectorOp Op, std::uint64_t DataIndex, std::uint64_t MarkPos, std::uint64_t Generation, const void* Payload, std::size_t PayloadSize) override
+	{
+		MutationRecord Record = {};
+		Record.mOp = static_cast<std::uint8_t>(Op);
+		Record.mPayloadSize = static_cast<std::uint32_t>(PayloadSize);
+		Record.mDataIndex = DataIndex;
+		Record.mMarkPos = MarkPos;
+		Record.mGeneration = Generation;
+
+		// The vector can't undo its mutation, so a record the follower didn't make room for is reported by overflowed()
+		write(Record, Payload);
+	}
+
+	void onState(const TVectorState& State) override
+	{
+		// The header first ...
+		MutationStateHeader Header = { State.mSize, State.mDefaultID, State.mLayoutBaseID, State.mForwardingGrace, State.mAtomsBytes, State.mMarksBytes, State.mForwardingBytes, State.mDataBytes };
+		MutationRecord Record = {};
+		Record.mOp = MutationRecord::StateBegin;
+		Record.mPayloadSize = sizeof(MutationStateHeader);
+		write(Record, &Header);
+
+		// ... then the tables in chunks small enough to stream through the log
+		writeStateChunks(State.mAtoms, State.mAtomsBytes);
+		writeStateChunks(State.mMarks, State.mMarksBytes);
+		writeStateChunks(State.mForwarding, State.mForwardingBytes);
+		writeStateChunks(State.mData, State.mDataBytes);
+	}
+
+private:
+
+	// Header shared between primary and follower, the ring buffer follows it
+	struct SharedHeader
+	{
+		std::atomic<std::uint64_t>	mHead;
+		std::atomic<std::uint64_t>	mTail;
+		std::atomic<std::uint64_t>	mOverflowed;
+		std::uint64_t				mCapacity;
+	};
+
+	// Checks whether a record of the specified size fits between the head and the follower
+	bool hasRoom(std::uint64_t Head, std::size_t RecordBytes) const
+	{
+		return mHeader->mCapacity - (Head - mHeader->mTail.load(std::memory_order_acquire)) >= RecordBytes;
+	}
+
+	// Record that the log dropped a record, always returns false for write()
+	bool setOverflowed() noexcept
+	{
+		mHeader->mOverflowed.store(1u, std::memory_order_release);
+		return false;
+	}
+
+	void initialize(void* Memory, std::size_t Capacity, bool Create)
+	{
+		mHeader = static_cast<SharedHeader*>(Memory);
+		mBuffer = static_cast<char*>(Memory) + sizeof(SharedHeader);
+
+		if (Create)
+		{
+			new(&mHeader->mHead) std::atomic<std::uint64_t>(0u);
+			new(&mHeader->mTail) std::atomic<std::uint64_t>(0u);
+			new(&mHeader->mOverflowed) std::atomic<std::uint64_t>(0u);
+			mHeader->mCapacity = Capacity;
+		}
+	}
+
+#ifdef TVECTOR_LOG_SHARED_MEMORY
+	void map(int FileDescriptor, std::size_t Capacity, bool Create)
+	{
+		auto Bytes = sizeof(SharedHeader) + Capacity;
+		if (Create && ::ftruncate(FileDescriptor, static_cast<off_t>(Bytes)) != 0)
+			throw std::system_error(errno, std::generic_category(), "MutationLog: can't size the log file");
+
+		auto Memory = ::mmap(nullptr, Bytes, PROT_READ | PROT_WRITE, MAP_SHARED, FileDescriptor, 0);
+		if (Memory == MAP_FAILED)
+			throw std::system_error(errno, std::generic_category(), "MutationLog: can't map the log file");
+
+		mMappedBytes = Bytes;
+		initialize(Memory, Capacity, Create);
+	}
+#endif
+
+	void writeStateChunks(const void* Source, std::size_t Bytes)
+	{
+		auto ChunkBytes = static_cast<std::size_t>(mHeader->mCapacity / 4);
+		auto Bytes8 = static_cast<const char*>(Source);
+
+		MutationRecord Record = {};
+		Record.mOp = MutationRecord::StateChunk;
+		for (std::size_t Offset = 0u; Offset < Bytes; Offset += ChunkBytes)
+		{
+			Record.mPayloadSize = static_cast<std::uint32_t>(Bytes - Offset < ChunkBytes ? Bytes - Offset : ChunkBytes);
+			write(Record, Bytes8 + Offset);
+		}
+	}
+
+	// Copy to/from the ring buffer, wrapping around its end
+	void copyIn(std::uint64_t Position, const void* Source, std::size_t Bytes)
+	{
+		auto Offset = static_cast<std::size_t>(Position % mHeader->mCapacity);
+		auto FirstPart = Bytes < mHeader->mCapacity - Offset ? Bytes : static_cast<std::size_t>(mHeader->mCapacity - Offset);
+
+		if (FirstPart)
+			std::memcpy(mBuffer + Offset, Source, FirstPart);
+		if (Bytes - FirstPart)
+			std::memcpy(mBuffer, static_cast<const char*>(Source) + FirstPart, Bytes - FirstPart);
+	}
+	void copyOut(std::uint64_t Position, void* Destination, std::size_t Bytes) const
+	{
+		auto Offset = static_cast<std::size_t>(Position % mHeader->mCapacity);
+		auto FirstPart = Bytes < mHeader->mCapacity - Offset ? Bytes : static_cast<std::size_t>(mHeader->mCapacity - Offset);
+
+		if (FirstPart)
+			std::memcpy(Destination, mBuffer + Offset, FirstPart);
+		if (Bytes - FirstPart)
+			std::memcpy(static_cast<char*>(Destination) + FirstPart, mBuffer, Bytes - FirstPart);
+	}
+
+private:
+	SharedHeader*				mHeader;
+	char*						mBuffer;
+	std::size_t					mMappedBytes;
+	std::chrono::nanoseconds	mWriteTimeout;
+};
+
+// Applies the records of a MutationLog to a follower vector, which ends up identical to the primary one, handles included
+template <class Type, class TPosition = unsigned int, class TID = std::uint32_t>
+class MutationReplayer
+{
+public:
+
+	using Vector = TVector<Type, TPosition, TID>;
+
+	MutationReplayer(MutationLog& Log, Vector& Target) :
+		mLog(Log),
+		mTarget(Target),
+		mStateReceived(0u)
+	{
+	}
+
+	// Apply up to a specified number of records, returns the number of applied records
+	std::size_t apply(std::size_t MaxRecords = std::size_t(-1))
+	{
+		std::size_t Applied = 0u;
+		for (; Applied < MaxRecords && mLog.read(mRecord, mPayload); ++Applied)
+		{
+			switch (mRecord.mOp)
+			{
+			case static_cast<std::uint8_t>(TVectorOp::EmplaceBack):
+				mTarget.emplaceBack(payloadElement());
+				break;
+
+			case static_cast<std::uint8_t>(TVectorOp::Emplace):
+				mTarget.emplace(mTarget.begin() + mRecord.mDataIndex, payloadElement());
+				break;
+
+			case static_cast<std::uint8_t>(TVectorOp::Erase):
+				mTarget.erase(mTarget.begin() + mRecord.mDataIndex);
+				break;
+
+			case static_cast<std::uint8_t>(TVectorOp::PopBack):
+				mTarget.popBack();
+				break;
+
+			case static_cast<std::uint8_t>(TVectorOp::Clear):
+				mTarget.clear();
+				break;
+
+			case static_cast<std::uint8_t>(TVectorOp::Assign):
+				for (std::size_t Offset = 0u; Offset < mPayload.size(); Offset += sizeof(Type))
+					mTarget[static_cast<typename Vector::Size>(mRecord.mDataIndex + Offset / sizeof(Type))] = payloadElement(Offset);
+				break;
+
+			case static_cast<std::uint8_t>(TVectorOp::OptimizeLayout):
+				mTarget.optimizeLayout(mRecord.mGeneration);
+				break;
+
+			case MutationRecord::StateBegin:
+				// Collect the chunks that follow
+				std::memcpy(&mStateHeader, mPayload.data(), sizeof(MutationStateHeader));
+				mState.resize(static_cast<std::size_t>(mStateHeader.mAtomsBytes + mStateHeader.mMarksBytes + mStateHeader.mForwardingBytes + mStateHeader.mDataBytes));
+				mStateReceived = 0u;
+				if (mState.empty())
+					loadState();
+				break;
+
+			case MutationRecord::StateChunk:
+				std::memcpy(mState.data() + mStateReceived, mPayload.data(), mPayload.size());
+				mStateReceived += mPayload.size();
+				if (mStateReceived == mState.size())
+					loadState();
+				break;
+			}
+		}
+
+		return Applied;
+	}
+
+private:
+
+	// An element carried by the current record, Offset bytes into its payload
+	const Type& payloadElement(std::size_t Offset = 0u)
+	{
+		std::memcpy(&mElement, mPayload.data() + Offset, sizeof(Type));
+		return reinterpret_cast<const Type&>(mElement);
+	}
+
+	// Replace the target with the collected state
+	void loadState()
+	{
+		TVectorState State;
+		State.mSize = mStateHeader.mSize;
+		State.mDefaultID = mStateHeader.mDefaultID;
+		State.mLayoutBaseID = mStateHeader.mLayoutBaseID;
+		State.mForwardingGrace = mStateHeader.mForwardingGrace;
+		State.mAtoms = mState.data();
+		State.mAtomsBytes = static_cast<std::size_t>(mStateHeader.mAtomsBytes);
+		State.mMarks = mState.data() + State.mAtomsBytes;
+		State.mMarksBytes = static_cast<std::size_t>(mStateHeader.mMarksBytes);
+		State.mForwarding = mState.data() + State.mAtomsBytes + State.mMarksBytes;
+		State.mForwardingBytes = static_cast<std::size_t>(mStateHeader.mForwardingBytes);
+		State.mData = mState.data() + State.mAtomsBytes + State.mMarksBytes + State.mForwardingBytes;
+		State.mDataBytes = static_cast<std::size_t>(mStateHeader.mDataBytes);
+
+		mTarget.loadState(State);
+	}
+
+private:
+	MutationLog&					mLog;
+	Vector&							mTarget;
+	MutationRecord					mRecord;
+	std::vector<char>				mPayload;
+	typename Vector::Data			mElement;
+
+	// Whole state being received
+	MutationStateHeader	mStateHeader;
+	std::vector<char>	mState;
+	std::size_t			mStateReceived;
+};
@@ -0,0 +1,678 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#include <tuple>
+
+// A vector whose elements are split in columns, each one stored in its own contiguous array
+// All the columns share a single atom/mark table, so one iterator reaches every column of an element
+// Like TVector, it takes the unsigned types of the positions and of the iterator IDs, TVectorSoA below uses the 32 bit defaults
+template <class TPosition, class TID, class... Columns>
+class BasicTVectorSoA
+{
+	static_assert(sizeof...(Columns) > 0, "A TVectorSoA needs at least one column");
+	static_assert(std::is_unsigned<TPosition>::value && std::is_unsigned<TID>::value, "Positions and IDs must be unsigned integers");
+
+	struct Atom;
+	struct Mark;
+
+public:
+
+	template <bool TConstness>
+	struct TIterator;
+
+	// Type aliases
+	using Position = TPosition;
+	using Size = TPosition;
+	using ID = TID;
+	using Iterator = TIterator<false>;
+	using CIterator = TIterator<true>;
+
+	template <std::size_t Column>
+	using ColumnType = std::tuple_element_t<Column, std::tuple<Columns...>>;
+
+	// Every column array starts on a cache line, so per column loops can use aligned vector loads
+	static constexpr std::size_t ColumnAlignment = 64;
+
+	// Number of columns
+	static constexpr std::size_t ColumnCount = sizeof...(Columns);
+
+private:
+
+	// Shifting all the columns together can't be undone half way
+	static_assert(std::is_same<std::integer_sequence<bool, true, TRelocator<Columns>::IsNoexcept...>, std::integer_sequence<bool, TRelocator<Columns>::IsNoexcept..., true>>::value, "Every column must be relocatable without throwing");
+
+	static constexpr Position InvalidPosition = Position(-1);
+
+	// The atom/mark tables work like the TVector ones, they're kept here because the TVector tables are tied to its single data array
+	// The "Atom" creates a link between the element position and the mark
+	struct Atom
+	{
+		Position mDataPos;
+		Position mMarkPos;
+	};
+
+	// The "Mark" is what the iterators point to, it survives the shifts of the atoms
+	struct Mark
+	{
+		Position mAtomPos;
+		ID mIteratorID;
+	};
+
+	// A cache line aligned array of one column
+	template <class Type>
+	struct ColumnArray
+	{
+		// Allocate an array of a specified capacity
+		static ColumnArray allocate(const Size& Capacity)
+		{
+			ColumnArray Array;
+			Array.mBuffer = new unsigned char[Capacity * sizeof(Type) + ColumnAlignment];
+
+			auto Address = reinterpret_cast<std::uintptr_t>(Array.mBuffer);
+			Array.mData = reinterpret_cast<Type*>((Address + ColumnAlignment - 1) & ~std::uintptr_t(ColumnAlignment - 1));
+
+			return Array;
+		}
+
+		void release()
+		{
+			delete[] mBuffer;
+			mBuffer = nullptr;
+			mData = nullptr;
+		}
+
+		unsigned char*	mBuffer = nullptr;
+		Type*			mData = nullptr;
+	};
+
+	using Indices = std::index_sequence_for<Columns...>;
+
+public:
+
+	// The "Iterator" keeps track of an element, whatever its position
+	// It moves and compares like a TVector iterator, but the element is split in columns so it's read with get<Column>() instead of *
+	// Const iterators (CIterator) only give const access to the columns
+	template <bool TConstness>
+	struct TIterator
+	{
+		using Parent = std::conditional_t<TConstness, const BasicTVectorSoA, BasicTVectorSoA>;
+		using difference_type = std::ptrdiff_t;
+
+		TIterator() :
+			mParentVector(nullptr),
+			mMarkPos(-1),
+			mIteratorID(-1)
+		{
+		}
+
+		// Create an iterator starting from the data position
+		TIterator(const Position& DataPosition, Parent* ParentVector) :
+			mParentVector(ParentVector),
+			mMarkPos(ParentVector->mAtomsVector[DataPosition].mMarkPos),
+			mIteratorID(ParentVector->mMarksVector[mMarkPos].mIteratorID)
+		{
+		}
+
+		// A mutable iterator converts to a const one
+		template <bool TOtherConstness, class = std::enable_if_t<TConstness && !TOtherConstness>>
+		TIterator(const TIterator<TOtherConstness>& Copy) :
+			mParentVector(Copy.mParentVector),
+			mMarkPos(Copy.mMarkPos),
+			mIteratorID(Copy.mIteratorID)
+		{
+		}
+
+		// Access a column of the pointed element
+		template <std::size_t Column>
+		std::conditional_t<TConstness, const ColumnType<Column>&, ColumnType<Column>&> get() const
+		{
+			assert(isValid());
+
+			return mParentVector->template get<Column>(index());
+		}
+
+		// Position of the pointed element in the column arrays
+		Position index() const
+		{
+			return mParentVector->mAtomsVector[mParentVector->mMarksVector[mMarkPos].mAtomPos].mDataPos;
+		}
+
+		// Check whether the iterator still points to an element (or to the end)
+		bool isValid() const
+		{
+			return mParentVector && mMarkPos < mParentVector->mMarksVector.size() && mParentVector->mMarksVector[mMarkPos].mIteratorID == mIteratorID;
+		}
+
+		// Arithmetic
+		TIterator& operator++()
+		{
+			return *this = *this + 1;
+		}
+		TIterator operator++(int)
+		{
+			auto Temp = *this;
+			++*this;
+			return Temp;
+		}
+		TIterator& operator--()
+		{
+			return *this = *this - 1;
+		}
+		TIterator operator--(int)
+		{
+			auto Temp = *this;
+			--*this;
+			return Temp;
+		}
+		TIterator& operator+=(const difference_type& Offset)
+		{
+			return *this = *this + Offset;
+		}
+		TIterator& operator-=(const difference_type& Offset)
+		{
+			return *this = *this - Offset;
+		}
+		TIterator operator+(const difference_type& Offset) const
+		{
+			return TIterator(static_cast<Position>(index() + Offset), mParentVector);
+		}
+		friend TIterator operator+(const difference_type& Offset, const TIterator& Right)
+		{
+			return Right + Offset;
+		}
+		TIterator operator-(const difference_type& Offset) const
+		{
+			return TIterator(static_cast<Position>(index() - Offset), mParentVector);
+		}
+		template <bool TOtherConstness>
+		difference_type operator-(const TIterator<TOtherConstness>& Right) const
+		{
+			return static_cast<difference_type>(index()) - static_cast<difference_type>(Right.index());
+		}
+
+		// Comparison
+		template <bool TOtherConstness>
+		bool operator==(const TIterator<TOtherConstness>& Right) const
+		{
+			return index() == Right.index();
+		}
+		template <bool TOtherConstness>
+		bool operator!=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(*this == Right);
+		}
+		template <bool TOtherConstness>
+		bool operator<(const TIterator<TOtherConstness>& Right) const
+		{
+			return index() < Right.index();
+		}
+		template <bool TOtherConstness>
+		bool operator>(const TIterator<TOtherConstness>& Right) const
+		{
+			return Right < *this;
+		}
+		template <bool TOtherConstness>
+		bool operator<=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(Right < *this);
+		}
+		template <bool TOtherConstness>
+		bool operator>=(const TIterator<TOtherConstness>& Right) const
+		{
+			return !(*this < Right);
+		}
+
+	private:
+		friend class BasicTVectorSoA;
+		template <bool TOtherConstness>
+		friend struct TIterator;
+
+		Parent*		mParentVector;
+		Position	mMarkPos;
+		ID			mIteratorID;
+	};
+
+	// Default constructor
+	BasicTVectorSoA() :
+		mVectorSize(0u),
+		mVectorCapacity(0u),
+		mIteratorDefaultID(0u)
+	{
+		// Create one iterator structure (atom, mark), this is our first iterator, and for now also the end() iterator
+		mAtomsVector.push_back({ 0u, 0u });
+		mMarksVector.push_back({ 0u, 0u });
+	}
+
+	// Copy constructor, every column is copied and the iterator structures (atom, mark) are kept as they are
+	BasicTVectorSoA(const BasicTVectorSoA& Copy) :
+		mVectorSize(0u),
+		mVectorCapacity(0u),
+		mIteratorDefaultID(Copy.mIteratorDefaultID),
+		mAtomsVector(Copy.mAtomsVector),
+		mMarksVector(Copy.mMarksVector)
+	{
+		// The destructor won't run if a copy throws, release what was built
+		try
+		{
+			reserve(Copy.mVectorSize);
+			copyElements(Copy, Indices());
+		}
+		catch (...)
+		{
+			destroyElements(0u, mVectorSize, Indices());
+			releaseColumns(mColumns, Indices());
+			throw;
+		}
+	}
+
+	// Move constructor, steals the columns and leaves the moved vector empty and ready to be used again
+	// The empty vector needs its own end() iterator structure, which is allocated before anything is stolen, so the move isn't noexcept
+	BasicTVectorSoA(BasicTVectorSoA&& Move) :
+		BasicTVectorSoA()
+	{
+		// Like clear(), the iterators left in the moved vector must not match its new end() mark
+		mIteratorDefaultID = Move.mIteratorDefaultID + 1u;
+		mMarksVector.back().mIteratorID = mIteratorDefaultID;
+
+		swap(Move);
+	}
+
+	// Default destructor
+	~BasicTVectorSoA()
+	{
+		destroyElements(0u, mVectorSize, Indices());
+		releaseColumns(mColumns, Indices());
+	}
+
+	// Copy/move assignment, the argument is built first so a throwing copy leaves the vector unchanged
+	BasicTVectorSoA& operator=(BasicTVectorSoA Copy) noexcept
+	{
+		swap(Copy);
+		return *this;
+	}
+
+#pragma region Element access
+
+	// Access a column of the specified element
+	template <std::size_t Column>
+	ColumnType<Column>& get(const Size& Index)
+	{
+		assert(Index < mVectorSize);
+
+		return std::get<Column>(mColumns).mData[Index];
+	}
+	template <std::size_t Column>
+	const ColumnType<Column>& get(const Size& Index) const
+	{
+		assert(Index < mVectorSize);
+
+		return std::get<Column>(mColumns).mData[Index];
+	}
+
+	// Direct access to the contiguous array of a column
+	template <std::size_t Column>
+	ColumnType<Column>* column() noexcept
+	{
+		return std::get<Column>(mColumns).mData;
+	}
+	template <std::size_t Column>
+	const ColumnType<Column>* column() const noexcept
+	{
+		return std::get<Column>(mColumns).mData;
+	}
+
+#pragma endregion
+
+#pragma region Iterators
+
+	Iterator begin()
+	{
+		return Iterator(0u, this);
+	}
+	CIterator begin() const
+	{
+		return CIterator(0u, this);
+	}
+	CIterator cbegin() const
+	{
+		return begin();
+	}
+
+	Iterator end()
+	{
+		return Iterator(mVectorSize, this);
+	}
+	CIterator end() const
+	{
+		return CIterator(mVectorSize, this);
+	}
+	CIterator cend() const
+	{
+		return end();
+	}
+
+#pragma endregion
+
+#pragma region Capacity
+
+	// Checks whether the container is empty
+	bool empty() const noexcept
+	{
+		return !mVectorSize;
+	}
+
+	// Returns the number of elements
+	const Size& size() const noexcept
+	{
+		return mVectorSize;
+	}
+
+	// Returns the number of elements that can be held in currently allocated storage
+	const Size& capacity() const noexcept
+	{
+		return mVectorCapacity;
+	}
+
+	// Reserves storage in every column
+	void reserve(const Size& NewCapacity)
+	{
+		if (NewCapacity > mVectorCapacity)
+			growColumns(NewCapacity, Indices());
+	}
+
+#pragma endregion
+
+#pragma region Modifiers
+
+	// Create an element at the end of the vector, one value for each column
+	template <class... TArgs>
+	Iterator emplaceBack(TArgs&&... Values)
+	{
+		static_assert(sizeof...(TArgs) == sizeof...(Columns), "emplaceBack needs one value for each column");
+
+		assert(mMarksVector.size() < InvalidPosition && "Too many insertions for the position type, call clear()");
+
+		// If we won't have enough space for a new element grows every column
+		if (mVectorSize + 1 > mVectorCapacity)
+			reserve(mVectorCapacity ? mVectorCapacity * 2 : 1u);
+
+		// Make room in the atom and mark tables first, so they can't throw once the element exists
+		reserveTables();
+
+		// Create the new element in place at the end of every column
+		constructElement(mVectorSize, Indices(), std::forward<TArgs>(Values)...);
+
+		// Create the right iterator structure (atom, mark) in place of the end() iterator
+		auto NewMarkPos = static_cast<Position>(mMarksVector.size() - 1);
+		mAtomsVector[mVectorSize] = { mVectorSize, NewMarkPos };
+		mMarksVector[NewMarkPos] = { mVectorSize, mIteratorDefaultID };
+
+		// Increase the vector size
+		++mVectorSize;
+
+		// Create a new end() iterator
+		mAtomsVector.push_back({ mVectorSize, static_cast<Position>(NewMarkPos + 1) });
+		mMarksVector.push_back({ mVectorSize, mIteratorDefaultID });
+
+		return Iterator(mVectorSize - 1, this);
+	}
+
+	// Insert an element before pos, one value for each column
+	template <class... TArgs>
+	Iterator emplace(const CIterator& InsertPosition, TArgs&&... Values)
+	{
+		static_assert(sizeof...(TArgs) == sizeof...(Columns), "emplace needs one value for each column");
+
+		if (InsertPosition == end())
+			return emplaceBack(std::forward<TArgs>(Values)...);
+
+		assert(mMarksVector.size() < InvalidPosition && "Too many insertions for the position type, call clear()");
+
+		auto Index = InsertPosition.index();
+
+		// Check if we have enough space in the columns
+		if (mVectorSize + 1 > mVectorCapacity)
+			reserve(mVectorCapacity * 2);
+
+		// Make room in the atom and mark tables before the columns are shifted, the rest can't throw
+		reserveTables();
+
+		// Shift every column past the insertion position to the right, and construct the new element in the gap
+		shiftColumns(Index + 1, Index, mVectorSize - Index, Indices());
+		try
+		{
+			constructElement(Index, Indices(), std::forward<TArgs>(Values)...);
+		}
+		catch (...)
+		{
+			shiftColumns(Index, Index + 1, mVectorSize - Index, Indices());
+			throw;
+		}
+
+		// The end() iterator structure is taken by the element, the atoms after the insertion point move to the right
+		auto NewMarkPos = static_cast<Position>(mMarksVector.size() - 1);
+		mAtomsVector.push_back({ static_cast<Position>(mVectorSize + 1), static_cast<Position>(NewMarkPos + 1) });
+		for (auto AtomPos = mVectorSize; AtomPos > Index; --AtomPos)
+		{
+			mAtomsVector[AtomPos] = { AtomPos, mAtomsVector[AtomPos - 1].mMarkPos };
+			mMarksVector[mAtomsVector[AtomPos].mMarkPos].mAtomPos = AtomPos;
+		}
+		mAtomsVector[Index] = { Index, NewMarkPos };
+		mMarksVector[NewMarkPos] = { Index, mIteratorDefaultID };
+		mMarksVector.push_back({ static_cast<Position>(mVectorSize + 1), mIteratorDefaultID });
+
+		// Increase the vector size
+		++mVectorSize;
+
+		return Iterator(Index, this);
+	}
+
+	// Removes the specified element from every column
+	Iterator erase(const CIterator& DeletePosition)
+	{
+		if (DeletePosition == end())
+			return end();
+
+		auto Index = DeletePosition.index();
+
+		// Destroy the element and relocate the rest of every column to the left
+		destroyElements(Index, Index + 1, Indices());
+		shiftColumns(Index, Index + 1, mVectorSize - Index - 1, Indices());
+
+		// Invalidates the connected mark
+		++mMarksVector[DeletePosition.mMarkPos].mIteratorID;
+
+		// Shift the atoms after the removed one to the left, the marks follow them
+		for (auto AtomPos = Index; AtomPos < mVectorSize; ++AtomPos)
+		{
+			mAtomsVector[AtomPos] = { AtomPos, mAtomsVector[AtomPos + 1].mMarkPos };
+			mMarksVector[mAtomsVector[AtomPos].mMarkPos].mAtomPos = AtomPos;
+		}
+		mAtomsVector.pop_back();
+
+		// Decrement the size of the vector
+		--mVectorSize;
+
+		return Iterator(Index, this);
+	}
+
+	// Remove the last element in the vector
+	void popBack()
+	{
+		assert(mVectorSize);
+
+		erase(Iterator(mVectorSize - 1, this));
+	}
+
+	// Clears the contents, every iterator is invalidated
+	void clear() noexcept
+	{
+		destroyElements(0u, mVectorSize, Indices());
+		mVectorSize = 0u;
+
+		// A new default ID makes all the old iterators invalid
+		++mIteratorDefaultID;
+		mAtomsVector.assign(1, { 0u, 0u });
+		mMarksVector.assign(1, { 0u, mIteratorDefaultID });
+	}
+
+	// Exchanges the contents with another vector
+	void swap(BasicTVectorSoA& Other) noexcept
+	{
+		std::swap(mVectorSize, Other.mVectorSize);
+		std::swap(mVectorCapacity, Other.mVectorCapacity);
+		std::swap(mIteratorDefaultID, Other.mIteratorDefaultID);
+		std::swap(mColumns, Other.mColumns);
+		mAtomsVector.swap(Other.mAtomsVector);
+		mMarksVector.swap(Other.mMarksVector);
+	}
+
+#pragma endregion
+
+private:
+
+	// Grow the atom and mark tables for one more element, the push_backs of an insertion then can't fail half way
+	void reserveTables()
+	{
+		if (mAtomsVector.size() == mAtomsVector.capacity())
+			mAtomsVector.reserve(mAtomsVector.size() * 2);
+		if (mMarksVector.size() == mMarksVector.capacity())
+			mMarksVector.reserve(mMarksVector.size() * 2);
+	}
+
+	// Construct every column of an element from its value
+	template <std::size_t... Column, class... TArgs>
+	void constructElement(const Position& Index, std::index_sequence<Column...>, TArgs&&... Values)
+	{
+		auto Arguments = std::forward_as_tuple(std::forward<TArgs>(Values)...);
+
+		// Construct the columns one by one, destroying the ones already built if a constructor throws
+		std::size_t Constructed = 0u;
+		try
+		{
+			using Expander = int[];
+			(void)Expander{ 0, (new(std::get<Column>(mColumns).mData + Index) ColumnType<Column>(std::get<Column>(std::move(Arguments))), ++Constructed, 0)... };
+		}
+		catch (...)
+		{
+			using Expander = int[];
+			(void)Expander{ 0, (Column < Constructed ? destroyObject(std::get<Column>(mColumns).mData[Index]) : void(), 0)... };
+			throw;
+		}
+	}
+
+	// Copy construct every column of the elements of another vector, mVectorSize counts the complete ones
+	template <std::size_t... Column>
+	void copyElements(const BasicTVectorSoA& Copy, std::index_sequence<Column...>)
+	{
+		for (; mVectorSize < Copy.mVectorSize; ++mVectorSize)
+			constructElement(mVectorSize, Indices(), std::get<Column>(Copy.mColumns).mData[mVectorSize]...);
+	}
+
+	// Call the destructor of a single column value
+	template <class Type>
+	static void destroyObject(Type& Object) noexcept
+	{
+		Object.~Type();
+	}
+
+	// Destroy every column of the elements in [First, Last)
+	template <std::size_t... Column>
+	void destroyElements(const Position& First, const Position& Last, std::index_sequence<Column...>) noexcept
+	{
+		using Expander = int[];
+		for (auto Index = First; Index < Last; ++Index)
+			(void)Expander{ 0, (destroyObject(std::get<Column>(mColumns).mData[Index]), 0)... };
+	}
+
+	// Relocate a range of every column inside the same arrays
+	template <std::size_t... Column>
+	void shiftColumns(const Position& Destination, const Position& Source, const Size& Count, std::index_sequence<Column...>)
+	{
+		using Expander = int[];
+		if (Destination < Source)
+			(void)Expander{ 0, (TRelocator<ColumnType<Column>>::relocateLeft(std::get<Column>(mColumns).mData + Destination, std::get<Column>(mColumns).mData + Source, Count), 0)... };
+		else
+			(void)Expander{ 0, (TRelocator<ColumnType<Column>>::relocateRight(std::get<Column>(mColumns).mData + Destination, std::get<Column>(mColumns).mData + Source, Count), 0)... };
+	}
+
+	// Move every column to bigger arrays
+	template <std::size_t... Column>
+	void growColumns(const Size& NewCapacity, std::index_sequence<Column...>)
+	{
+		// Allocate all the arrays first, so running out of memory leaves the vector untouched
+		std::tuple<ColumnArray<Columns>...> NewColumns;
+		try
+		{
+			using Expander = int[];
+			(void)Expander{ 0, (std::get<Column>(NewColumns) = ColumnArray<Columns>::allocate(NewCapacity), 0)... };
+		}
+		catch (...)
+		{
+			releaseColumns(NewColumns, Indices());
+			throw;
+		}
+
+		// Relocate the elements, the relocation can't fail once it has started
+		using Expander = int[];
+		(void)Expander{ 0, (TRelocator<ColumnType<Column>>::relocate(std::get<Column>(NewColumns).mData, std::get<Column>(mColumns).mData, mVectorSize), 0)... };
+
+		releaseColumns(mColumns, Indices());
+		mColumns = NewColumns;
+		mVectorCapacity = NewCapacity;
+	}
+
+	// Release the arrays of every column
+	template <std::size_t... Column>
+	static void releaseColumns(std::tuple<ColumnArray<Columns>...>& ColumnArrays, std::index_sequence<Column...>) noexcept
+	{
+		using Expander = int[];
+		(void)Expander{ 0, (std::get<Column>(ColumnArrays).release(), 0)... };
+	}
+
+private:
+	Size	mVectorSize;
+	Size	mVectorCapacity;
+	ID		mIteratorDefaultID;
+
+	// One array for each column
+	std::tuple<ColumnArray<Columns>...>	mColumns;
+
+	// The iterator structures shared by all the columns
+	std::vector<Atom>	mAtomsVector;
+	std::vector<Mark>	mMarksVector;
+};
+
+// Specialize the swap function
+template <class TPosition, class TID, class... Columns>
+void swap(BasicTVectorSoA<TPosition, TID, Columns...>& Left, BasicTVectorSoA<TPosition, TID, Columns...>& Right) noexcept
+{
+	Left.swap(Right);
+}
+
+// Column vector with 32 bit positions and IDs
+template <class... Columns>
+using TVectorSoA = BasicTVectorSoA<unsigned int, std::uint32_t, Columns...>;
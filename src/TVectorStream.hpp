@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////
+//
+// https://github.com/assematt | assenza.matteo@gmail.com
+// Copyright (C) - 2017 - Assenza Matteo
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files(the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial
+// portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT
+// LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+// WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "TVector.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+// Reads a byte stream on a background thread, a few blocks ahead of the consumer
+// Used as the source of TVector::appendFrom, so the I/O of the next blocks overlaps the construction of the elements
+class AsyncByteReader
+{
+public:
+
+	// Read(Buffer, Bytes) fills the buffer with up to Bytes bytes and returns how many it read, 0 means the stream is over
+	AsyncByteReader(std::function<std::size_t(void*, std::size_t)> Read, std::size_t BlockBytes = 1 << 20, std::size_t BlockCount = 2) :
+		mRead(std::move(Read)),
+		mBlockBytes(BlockBytes),
+		mBlocks(BlockCount),
+		mReadBlock(0u),
+		mReadOffset(0u),
+		mStop(false)
+	{
+		assert(BlockBytes > 0 && BlockCount > 0);
+
+		for (auto& Block : mBlocks)
+			Block.mBytes.resize(BlockBytes);
+
+		mThread = std::thread(&AsyncByteReader::readBlocks, this);
+	}
+
+	AsyncByteReader(const AsyncByteReader& Copy) = delete;
+	AsyncByteReader& operator=(const AsyncByteReader& Copy) = delete;
+
+	// Stop the background thread, the rest of the stream is not read
+	~AsyncByteReader()
+	{
+		{
+			std::lock_guard<std::mutex> Lock(mMutex);
+			mStop = true;
+		}
+		mBlockFreed.notify_all();
+
+		mThread.join();
+	}
+
+	// Copy up to Bytes bytes to the destination, waiting for the background thread if needed
+	// Returns less than Bytes only when the stream is over, and rethrows what the read function threw
+	std::size_t read(void* Destination, std::size_t Bytes)
+	{
+		auto Output = static_cast<unsigned char*>(Destination);
+		auto Copied = std::size_t(0);
+
+		while (Copied < Bytes)
+		{
+			auto& Block = mBlocks[mReadBlock];
+
+			// Wait until the background thread has filled the block
+			{
+				std::unique_lock<std::mutex> Lock(mMutex);
+				mBlockFilled.wait(Lock, [&Block] { return Block.mState != BlockState::Free; });
+
+				if (Block.mState == BlockState::Failed)
+					std::rethrow_exception(mError);
+				if (Block.mState == BlockState::End)
+					break;
+			}
+
+			// Copy what we can from the block
+			auto Available = Block.mFilled - mReadOffset;
+			auto Count = Available < Bytes - Copied ? Available : Bytes - Copied;
+			std::memcpy(Output + Copied, Block.mBytes.data() + mReadOffset, Count);
+			Copied += Count;
+			mReadOffset += Count;
+
+			// Give the block back to the background thread once it's empty
+			if (mReadOffset == Block.mFilled)
+			{
+				{
+					std::lock_guard<std::mutex> Lock(mMutex);
+					Block.mState = BlockState::Free;
+				}
+				mBlockFreed.notify_one();
+
+				mReadBlock = (mReadBlock + 1) % mBlocks.size();
+				mReadOffset = 0u;
+			}
+		}
+
+		return Copied;
+	}
+
+	// A TVector::appendFrom source that reads whole elements of a trivially copyable type, a trailing partial element is dropped
+	template <class Type>
+	std::function<std::size_t(Type*, std::size_t)> elements()
+	{
+		static_assert(std::is_trivially_copyable<Type>::value, "The elements are read as raw bytes");
+
+		return [this](Type* Destination, std::size_t MaxCount) { return read(Destination, MaxCount * sizeof(Type)) / sizeof(Type); };
+	}
+
+private:
+
+	enum class BlockState : std::uint8_t
+	{
+		Free,
+		Filled,
+		End,
+		Failed
+	};
+
+	struct Block
+	{
+		std::vector<unsigned char>	mBytes;
+		std::size_t					mFilled = 0u;
+		BlockState					mState = BlockState::Free;
+	};
+
+	// Background thread, fill the free blocks in order until the stream is over
+	void readBlocks()
+	{
+		for (auto WriteBlock = std::size_t(0);; WriteBlock = (WriteBlock + 1) % mBlocks.size())
+		{
+			auto& Block = mBlocks[WriteBlock];
+
+			// Wait until the consumer has emptied the block
+			{
+				std::unique_lock<std::mutex> Lock(mMutex);
+				mBlockFreed.wait(Lock, [this, &Block] { return mStop || Block.mState == BlockState::Free; });
+
+				if (mStop)
+					return;
+			}
+
+			// Fill the block outside of the lock
+			auto State = BlockState::Filled;
+			try
+			{
+				Block.mFilled = 0u;
+				while (Block.mFilled < mBlockBytes)
+				{
+					auto Count = mRead(Block.mBytes.data() + Block.mFilled, mBlockBytes - Block.mFilled);
+					if (!Count)
+						break;
+
+					Block.mFilled += Count;
+				}
+
+				if (!Block.mFilled)
+					State = BlockState::End;
+			}
+			catch (...)
+			{
+				mError = std::current_exception();
+				State = BlockState::Failed;
+			}
+
+			{
+				std::lock_guard<std::mutex> Lock(mMutex);
+				Block.mState = State;
+			}
+			mBlockFilled.notify_one();
+
+			if (State != BlockState::Filled)
+				return;
+		}
+	}
+
+private:
+	std::function<std::size_t(void*, std::size_t)>	mRead;
+	std::size_t										mBlockBytes;
+	std::vector<Block>								mBlocks;
+
+	// Consumer position
+	std::size_t	mReadBlock;
+	std::size_t	mReadOffset;
+
+	// Background thread and its synchronization
+	std::thread					mThread;
+	std::mutex					mMutex;
+	std::condition_variable		mBlockFilled;
+	std::condition_variable		mBlockFreed;
+	std::exception_ptr			mError;
+	bool						mStop;
+};
@@ -0,0 +1,85 @@
+// Append throughput of ConcurrentTVector and ShardedTVector against a TVector guarded by a mutex
+// Every run appends the same total number of elements, split between 1 to 64 threads
+// "ConcurrentBenchmark [Elements]"
+
+#include <ConcurrentTVector.hpp>
+#include <ShardedTVector.hpp>
+#include <TVector.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Runs Append(ThreadIndex, Count) on every thread and returns the elapsed seconds
+template <class TAppend>
+double runThreads(size_t Threads, size_t Elements, TAppend Append)
+{
+	vector<thread> Workers;
+	auto Start = chrono::steady_clock::now();
+	for (auto ThreadIndex = size_t(0); ThreadIndex < Threads; ++ThreadIndex)
+		Workers.emplace_back(Append, ThreadIndex, Elements / Threads);
+	for (auto& Worker : Workers)
+		Worker.join();
+
+	return chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+}
+
+int main(int argc, char** argv)
+{
+	auto Elements = argc > 1 ? strtoul(argv[1], nullptr, 10) : 8000000ul;
+
+	printf("%8s %16s %16s %16s %16s\n", "Threads", "Mutex TVector", "emplaceBack", "Producer", "Sharded");
+	for (auto Threads = size_t(1); Threads <= 64u; Threads *= 2)
+	{
+		// Mutex guarded TVector
+		TVector<size_t> LockedVector;
+		mutex Lock;
+		auto LockedSeconds = runThreads(Threads, Elements, [&](size_t ThreadIndex, size_t Count)
+		{
+			for (auto Index = size_t(0); Index < Count; ++Index)
+			{
+				lock_guard<mutex> Guard(Lock);
+				LockedVector.pushBack(ThreadIndex + Index);
+			}
+		});
+
+		// One atomic increment per element
+		ConcurrentTVector<size_t> SharedVector;
+		auto SharedSeconds = runThreads(Threads, Elements, [&](size_t ThreadIndex, size_t Count)
+		{
+			for (auto Index = size_t(0); Index < Count; ++Index)
+				SharedVector.pushBack(ThreadIndex + Index);
+		});
+
+		// One atomic increment per block of slots
+		ConcurrentTVector<size_t> ProducerVector;
+		auto ProducerSeconds = runThreads(Threads, Elements, [&](size_t ThreadIndex, size_t Count)
+		{
+			auto Producer = ProducerVector.producer(256u);
+			for (auto Index = size_t(0); Index < Count; ++Index)
+				Producer.emplaceBack(ThreadIndex + Index);
+		});
+
+		// One lock per shard, every thread appends to its own
+		ShardedTVector<size_t, 64> ShardedVector;
+		auto ShardedSeconds = runThreads(Threads, Elements, [&](size_t ThreadIndex, size_t Count)
+		{
+			for (auto Index = size_t(0); Index < Count; ++Index)
+				ShardedVector.pushBack(ThreadIndex + Index);
+		});
+
+		if (ShardedVector.size() != LockedVector.size() || LockedVector.size() != SharedVector.publishedSize() || SharedVector.publishedSize() != Elements / Threads * Threads)
+		{
+			printf("Wrong number of elements with %zu threads\n", Threads);
+			return 1;
+		}
+
+		printf("%8zu %12.1f M/s %12.1f M/s %12.1f M/s %12.1f M/s\n", Threads, Elements / LockedSeconds / 1e6, Elements / SharedSeconds / 1e6, Elements / ProducerSeconds / 1e6, Elements / ShardedSeconds / 1e6);
+	}
+
+	return 0;
+}
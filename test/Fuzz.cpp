@@ -0,0 +1,524 @@
+// Differential fuzzer for TVector
+// Random operation sequences are applied to a TVector and to a std::vector model, while a shadow list remembers
+// which element every iterator taken so far must point to, so a broken iterator is caught as soon as it happens
+//
+// Build with -fsanitize=address,undefined to catch the lifetime errors as well
+// Define TVECTOR_LIBFUZZER and link with -fsanitize=fuzzer to get a libFuzzer target
+// Otherwise the program runs random seeds: "Fuzz [Seeds] [Operations]"
+// or a throughput run that only checks the final state: "Fuzz --stress [Operations]"
+
+#include <TVector.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Stop at the first difference, so the fuzzer reports the input that caused it
+#define FUZZ_CHECK(Condition, Message) \
+	if (!(Condition)) \
+	{ \
+		fprintf(stderr, "Fuzz check failed: %s (%s:%d)\n", Message, __FILE__, __LINE__); \
+		abort(); \
+	}
+
+// Element with an owned allocation, counts the live instances to find leaks and double destructions
+struct Tracked
+{
+	Tracked() :
+		mID(-1)
+	{
+		++LiveCount;
+	}
+
+	explicit Tracked(int ID) :
+		mID(ID),
+		mText(24 + ID % 8, 'x')
+	{
+		++LiveCount;
+	}
+
+	Tracked(const Tracked& Copy) :
+		mID(Copy.mID),
+		mText(Copy.mText)
+	{
+		FUZZ_CHECK(Copy.mID != DestroyedID, "copy of a destroyed element");
+		++LiveCount;
+	}
+
+	Tracked(Tracked&& Move) noexcept :
+		mID(Move.mID),
+		mText(std::move(Move.mText))
+	{
+		FUZZ_CHECK(Move.mID != DestroyedID, "move of a destroyed element");
+		++LiveCount;
+	}
+
+	Tracked& operator=(const Tracked& Copy) = default;
+	Tracked& operator=(Tracked&& Move) = default;
+
+	~Tracked()
+	{
+		FUZZ_CHECK(mID != DestroyedID, "element destroyed twice");
+		mID = DestroyedID;
+		--LiveCount;
+	}
+
+	static constexpr int DestroyedID = -12345;
+	static long LiveCount;
+
+	int		mID;
+	string	mText;
+};
+long Tracked::LiveCount = 0;
+
+// Element constructors and element identity for the tested types
+inline int makeElement(int ID, int*)
+{
+	return ID;
+}
+inline Tracked makeElement(int ID, Tracked*)
+{
+	return Tracked(ID);
+}
+inline int elementID(const int& Element)
+{
+	return Element;
+}
+inline int elementID(const Tracked& Element)
+{
+	FUZZ_CHECK(Element.mID != Tracked::DestroyedID, "access to a destroyed element");
+	return Element.mID;
+}
+
+// Reads the operations out of the fuzzer input
+class ByteStream
+{
+public:
+	ByteStream(const uint8_t* Data, size_t Size) :
+		mData(Data),
+		mSize(Size),
+		mPosition(0u)
+	{
+	}
+
+	bool empty() const
+	{
+		return mPosition >= mSize;
+	}
+
+	// Returns a number in [0, Range)
+	unsigned int next(unsigned int Range)
+	{
+		unsigned int Value = 0u;
+		for (auto Byte = 0; Byte < 2 && mPosition < mSize; ++Byte)
+			Value = (Value << 8) | mData[mPosition++];
+
+		return Range ? Value % Range : 0u;
+	}
+
+private:
+	const uint8_t*	mData;
+	size_t			mSize;
+	size_t			mPosition;
+};
+
+// The vector under test, its model and the iterators taken so far
+template <class Type, class Vector = TVector<Type>>
+class Harness
+{
+	using Iterator = typename Vector::Iterator;
+
+	// An iterator and the element it must point to
+	struct Handle
+	{
+		Iterator	mIterator;
+		int			mID;
+	};
+
+	static constexpr unsigned int MaxSize = 512u;
+	static constexpr unsigned int MaxHandles = 64u;
+
+public:
+	Harness(bool Check) :
+		mCheck(Check),
+		mNextID(0)
+	{
+	}
+
+	// Run every operation of the input, returns the number of operations
+	size_t run(ByteStream& Input)
+	{
+		size_t Steps = 0u;
+		for (; !Input.empty(); ++Steps)
+		{
+			step(Input);
+
+			if (mCheck)
+				verify();
+		}
+
+		verify();
+		return Steps;
+	}
+
+private:
+
+	// Apply a random operation to both the vector and the model
+	void step(ByteStream& Input)
+	{
+		auto Size = static_cast<unsigned int>(mModel.size());
+
+		switch (Input.next(18))
+		{
+		case 0:
+		case 1:
+			// pushBack
+			if (Size < MaxSize)
+			{
+				auto ID = mNextID++;
+				track(mVector.pushBack(makeElement(ID, static_cast<Type*>(nullptr))), ID);
+				mModel.push_back(ID);
+			}
+			break;
+
+		case 2:
+		case 3:
+			// emplace anywhere
+			if (Size < MaxSize)
+			{
+				auto Index = Input.next(Size + 1);
+				auto ID = mNextID++;
+				track(mVector.emplace(mVector.begin() + Index, makeElement(ID, static_cast<Type*>(nullptr))), ID);
+				mModel.insert(mModel.begin() + Index, ID);
+			}
+			break;
+
+		case 4:
+		case 5:
+			// erase one element
+			if (Size)
+			{
+				auto Index = Input.next(Size);
+				mVector.erase(mVector.begin() + Index);
+				mModel.erase(mModel.begin() + Index);
+			}
+			break;
+
+		case 6:
+			// erase a range
+			if (Size)
+			{
+				auto First = Input.next(Size + 1);
+				auto Last = First + Input.next(Size - First + 1);
+				mVector.erase(mVector.begin() + First, mVector.begin() + Last);
+				mModel.erase(mModel.begin() + First, mModel.begin() + Last);
+			}
+			break;
+
+		case 7:
+			// popBack
+			if (Size)
+			{
+				mVector.popBack();
+				mModel.pop_back();
+			}
+			break;
+
+		case 8:
+			// insert a few elements
+			if (Size < MaxSize)
+			{
+				auto Index = Input.next(Size + 1);
+				vector<Type> Elements;
+				for (auto Count = Input.next(8); Count > 0; --Count)
+					Elements.push_back(makeElement(mNextID++, static_cast<Type*>(nullptr)));
+
+				mVector.insert(mVector.begin() + Index, Elements.begin(), Elements.end());
+				for (auto& Element : Elements)
+					mModel.insert(mModel.begin() + Index++, elementID(Element));
+			}
+			break;
+
+		case 9:
+			// append and emplaceBackN
+			if (Size < MaxSize)
+			{
+				auto FirstID = mNextID;
+				auto Count = Input.next(16);
+				if (Input.next(2))
+					mVector.emplaceBackN(Count, [FirstID](unsigned int Index) { return makeElement(FirstID + static_cast<int>(Index), static_cast<Type*>(nullptr)); });
+				else
+				{
+					vector<Type> Elements;
+					for (auto Index = 0u; Index < Count; ++Index)
+						Elements.push_back(makeElement(FirstID + static_cast<int>(Index), static_cast<Type*>(nullptr)));
+					mVector.append(Elements.begin(), Elements.end());
+				}
+
+				for (auto Index = 0u; Index < Count; ++Index)
+					mModel.push_back(mNextID++);
+			}
+			break;
+
+		case 10:
+			// shrink with resize
+			{
+				auto NewSize = Input.next(Size + 1);
+				mVector.resize(NewSize);
+				mModel.resize(NewSize);
+			}
+			break;
+
+		case 11:
+			// clear, rarely
+			if (!Input.next(8))
+			{
+				mVector.clear();
+				mModel.clear();
+			}
+			break;
+
+		case 12:
+			// renumber the marks, the old iterators go through the remap
+			{
+				auto Grace = Input.next(2);
+				auto Remap = mVector.optimizeLayout(Grace);
+				for (auto& Entry : mHandles)
+				{
+					FUZZ_CHECK(Entry.mIterator.isValid() == (Grace && !Remap.rebased() && isAlive(Entry.mID)), "iterator validity after optimizeLayout");
+					Entry.mIterator = Remap(Entry.mIterator);
+				}
+			}
+			break;
+
+		case 13:
+			// copy, move and swap, the iterators of the vector must survive the round trip
+			{
+				Vector Copy(mVector);
+				FUZZ_CHECK(Copy.size() == mModel.size(), "copy size");
+				for (auto Index = 0u; Index < Copy.size(); ++Index)
+					FUZZ_CHECK(elementID(Copy[Index]) == mModel[Index], "copy content");
+
+				Vector Moved(std::move(mVector));
+				mVector = std::move(Moved);
+				Copy.swap(mVector);
+				Copy.swap(mVector);
+			}
+			break;
+
+		case 14:
+			// incremental growth, relocations split across threads, shrinking after removals
+			mVector.setMigrationBudget(Input.next(4));
+			mVector.setParallelRelocation(Input.next(2) ? 16u : 0u);
+			mVector.setShrinkPolicy(Input.next(2) ? 4u : 0u);
+			break;
+
+		case 15:
+			// remember an iterator to an existing element
+			if (Size)
+			{
+				auto Index = Input.next(Size);
+				track(mVector.begin() + Index, mModel[Index]);
+			}
+			break;
+
+		case 16:
+			// batched inserts and erasures, the positions are taken before the batch
+			{
+				auto Batch = mVector.beginBatch();
+				vector<pair<unsigned int, int>> Inserts;
+				vector<Iterator> Inserted;
+				vector<bool> Erased(Size, false);
+				auto Count = Input.next(8);
+				for (auto Index = 0u; Index < Count; ++Index)
+				{
+					if (Size && Input.next(2))
+					{
+						auto Position = Input.next(Size);
+						if (!Erased[Position])
+						{
+							Erased[Position] = true;
+							Batch.erase(mVector.begin() + Position);
+						}
+					}
+					else if (Size + Inserts.size() < MaxSize)
+					{
+						auto Position = Input.next(Size + 1);
+						auto ID = mNextID++;
+						Inserted.push_back(Batch.emplace(mVector.begin() + Position, makeElement(ID, static_cast<Type*>(nullptr))));
+						Inserts.emplace_back(Position, ID);
+					}
+				}
+				Batch.commit();
+
+				// The inserts at the same position keep the order they were recorded in
+				for (auto Index = 0u; Index < Inserted.size(); ++Index)
+					track(Inserted[Index], Inserts[Index].second);
+
+				stable_sort(Inserts.begin(), Inserts.end(), [](const pair<unsigned int, int>& Left, const pair<unsigned int, int>& Right) { return Left.first < Right.first; });
+				vector<int> NewModel;
+				auto NextInsert = 0u;
+				for (auto Index = 0u; Index <= Size; ++Index)
+				{
+					for (; NextInsert < Inserts.size() && Inserts[NextInsert].first == Index; ++NextInsert)
+						NewModel.push_back(Inserts[NextInsert].second);
+					if (Index < Size && !Erased[Index])
+						NewModel.push_back(mModel[Index]);
+				}
+				mModel.swap(NewModel);
+			}
+			break;
+
+		case 17:
+			// single pass removal of every element with a given ID residue
+			{
+				auto Divisor = static_cast<int>(Input.next(4)) + 2;
+				auto Residue = static_cast<int>(Input.next(static_cast<unsigned int>(Divisor)));
+				auto Matches = [Divisor, Residue](int ID) { return ID % Divisor == Residue; };
+
+				auto Removed = Input.next(2) ? mVector.eraseIf([&](const Type& Element) { return Matches(elementID(Element)); }) : mVector.retainIf([&](const Type& Element) { return !Matches(elementID(Element)); });
+				auto NewEnd = remove_if(mModel.begin(), mModel.end(), Matches);
+				FUZZ_CHECK(Removed == static_cast<unsigned int>(mModel.end() - NewEnd), "eraseIf count");
+				mModel.erase(NewEnd, mModel.end());
+			}
+			break;
+		}
+	}
+
+	// Remember an iterator, replacing a random old one when there are too many
+	void track(const Iterator& NewIterator, int ID)
+	{
+		if (mHandles.size() < MaxHandles)
+			mHandles.push_back({ NewIterator, ID });
+		else
+			mHandles[static_cast<unsigned int>(ID) % MaxHandles] = { NewIterator, ID };
+	}
+
+	bool isAlive(int ID) const
+	{
+		return find(mModel.begin(), mModel.end(), ID) != mModel.end();
+	}
+
+	// Compare the vector with the model and every iterator with the shadow list
+	void verify()
+	{
+		const Vector& Constant = mVector;
+
+		FUZZ_CHECK(mVector.size() == mModel.size(), "size");
+		FUZZ_CHECK(mVector.capacity() >= mVector.size(), "capacity");
+		FUZZ_CHECK(mVector.end() - mVector.begin() == static_cast<ptrdiff_t>(mModel.size()), "iterator distance");
+
+		for (auto Index = 0u; Index < mModel.size(); ++Index)
+			FUZZ_CHECK(elementID(Constant[Index]) == mModel[Index], "content");
+
+		// Walk with the iterators as well
+		auto Index = 0u;
+		for (auto Element = mVector.begin(); Element != mVector.end(); ++Element, ++Index)
+			FUZZ_CHECK(elementID(*Element) == mModel[Index], "iteration");
+
+		// Every iterator must be valid as long as its element is in the vector, and point to it wherever it moved
+		for (auto& Entry : mHandles)
+		{
+			auto Position = find(mModel.begin(), mModel.end(), Entry.mID);
+			if (Position == mModel.end())
+			{
+				FUZZ_CHECK(!Entry.mIterator.isValid(), "iterator of an erased element is still valid");
+				continue;
+			}
+
+			FUZZ_CHECK(Entry.mIterator.isValid(), "iterator of an element in the vector is not valid");
+			FUZZ_CHECK(elementID(*Entry.mIterator) == Entry.mID, "iterator points to the wrong element");
+			FUZZ_CHECK(Entry.mIterator - mVector.begin() == Position - mModel.begin(), "iterator position");
+		}
+	}
+
+private:
+	bool			mCheck;
+	int				mNextID;
+	Vector			mVector;
+	vector<int>		mModel;
+	vector<Handle>	mHandles;
+};
+
+// Run the same input on a trivially copyable and on a non trivial element type, and with narrow and wide positions
+// Returns the number of operations executed by all of them
+static size_t runInput(const uint8_t* Data, size_t Size, bool Check)
+{
+	size_t Steps = 0u;
+	{
+		ByteStream Input(Data, Size);
+		Steps += Harness<int>(Check).run(Input);
+	}
+	{
+		ByteStream Input(Data, Size);
+		Steps += Harness<int, TVector<int, uint16_t, uint16_t>>(Check).run(Input);
+	}
+	{
+		ByteStream Input(Data, Size);
+		Steps += Harness<int, TVector<int, uint64_t, uint64_t>>(Check).run(Input);
+	}
+	{
+		ByteStream Input(Data, Size);
+		Steps += Harness<Tracked>(Check).run(Input);
+	}
+
+	FUZZ_CHECK(Tracked::LiveCount == 0, "elements leaked or destroyed twice");
+	return Steps;
+}
+
+#ifdef TVECTOR_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* Data, size_t Size)
+{
+	runInput(Data, Size, true);
+	return 0;
+}
+
+#else
+
+int main(int argc, char** argv)
+{
+	// Throughput run, only the final state is checked
+	if (argc > 1 && string(argv[1]) == "--stress")
+	{
+		auto Operations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 10000000ul;
+
+		mt19937 Generator(42);
+		vector<uint8_t> Input(Operations * 4);
+		for (auto& Byte : Input)
+			Byte = static_cast<uint8_t>(Generator());
+
+		// Operations read a variable number of bytes, so count the ones actually executed
+		auto Start = chrono::steady_clock::now();
+		auto Steps = runInput(Input.data(), Input.size(), false);
+		auto Seconds = chrono::duration<double>(chrono::steady_clock::now() - Start).count();
+
+		printf("Stress: %zu operations over 4 vector types in %.3f s (%.0f operations/s)\n", Steps, Seconds, Steps / Seconds);
+		return 0;
+	}
+
+	// Random seeds, every operation is checked
+	auto Seeds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200ul;
+	auto Operations = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000ul;
+
+	for (auto Seed = 0ul; Seed < Seeds; ++Seed)
+	{
+		mt19937 Generator(static_cast<unsigned int>(Seed));
+		vector<uint8_t> Input(Operations * 4);
+		for (auto& Byte : Input)
+			Byte = static_cast<uint8_t>(Generator());
+
+		runInput(Input.data(), Input.size(), true);
+	}
+
+	printf("Fuzz: %lu seeds of %lu operations passed\n", Seeds, Operations);
+	return 0;
+}
+
+#endif
@@ -1,8 +1,22 @@
 #include <TVector.hpp>
+#include <ConcurrentTVector.hpp>
+#include <GapTVector.hpp>
+#include <ShardedTVector.hpp>
+#include <SortedTVector.hpp>
+#include <StaticTVector.hpp>
+#include <TVectorIndexed.hpp>
+#include <TVectorLog.hpp>
+#include <TVectorSoA.hpp>
+#include <TVectorStream.hpp>
+#include <array>
+#include <chrono>
+#include <deque>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <thread>
 #include <map>
+#include <stdexcept>
 
 using namespace std;
 
@@ -21,6 +35,56 @@ bool testValue(T Expected, U Received)
 	return Test;	
 }
 
+// Build a lookup table at compile time
+constexpr StaticTVector<int, 8> makeStaticTable()
+{
+	StaticTVector<int, 8> Table;
+	for (auto Value = 1; Value <= 5; ++Value)
+		Table.pushBack(Value * 10);
+
+	Table.erase(Table.begin() + 1);
+	Table.emplace(Table.begin(), 5);
+
+	return Table;
+}
+
+// Element whose constructor throws for negative values
+struct ThrowingValue
+{
+	ThrowingValue(int Value) : mName(to_string(Value))
+	{
+		if (Value < 0)
+			throw runtime_error("negative value");
+	}
+
+	string mName;
+};
+
+// Element whose copies throw once a budget runs out, and that has no move constructor
+struct FragileValue
+{
+	FragileValue(int Value) : mValue(Value)
+	{
+	}
+
+	FragileValue(const FragileValue& Copy) : mValue(Copy.mValue)
+	{
+		if (CopiesLeft-- == 0)
+			throw runtime_error("copy failed");
+	}
+
+	FragileValue& operator=(const FragileValue& Copy) = default;
+
+	bool operator<(const FragileValue& Right) const
+	{
+		return mValue < Right.mValue;
+	}
+
+	int mValue;
+	static int CopiesLeft;
+};
+int FragileValue::CopiesLeft = 0;
+
 int main()
 {
 	// Create 2 vectors
@@ -149,11 +213,10 @@ int main()
 	auto StdSize = StdVector.size();
 	TestResults.push_back(testValue(StdSize, CustomSize));
 
-	// Check max_size() function
+	// Check max_size() function, bound by the position type whose last value is reserved
 	cout << "Testing max_size() function: ";
 	CustomSize = CustomVector.max_size();
-	StdSize = StdVector.max_size();
-	TestResults.push_back(testValue(StdSize, CustomSize));
+	TestResults.push_back(testValue(numeric_limits<unsigned int>::max() - 1u, CustomSize));
 
 	// Check capacity() function
 	cout << "Testing capacity() function: ";
@@ -231,6 +294,572 @@ int main()
 	StdVector.clear();
 	TestResults.push_back(testValue(StdVector.size(), CustomVector.size()));
 
+	// Check incremental growth
+	cout << "Testing incremental growth: ";
+	TVector<int> MigratingVector;
+	MigratingVector.setMigrationBudget(1);
+	auto MigratingIterator = MigratingVector.pushBack(0);
+	for (auto Index = 1; Index < 100; ++Index)
+		MigratingVector.pushBack(Index);
+	bool MigrationCorrect = MigratingVector.isMigrating();
+	for (auto Index = 0; Index < 100; ++Index)
+		MigrationCorrect = MigrationCorrect && MigratingVector[Index] == Index;
+	MigratingVector.data();
+	MigrationCorrect = MigrationCorrect && !MigratingVector.isMigrating() && *MigratingIterator == 0;
+	TestResults.push_back(testValue(true, MigrationCorrect));
+
+	// Check copy/move constructors and swap
+	cout << "Testing copy constructor: ";
+	TVector<string> SourceVector;
+	SourceVector.pushBack("first");
+	SourceVector.pushBack("second");
+	TVector<string> CopiedVector(SourceVector);
+	CopiedVector[0] = "changed";
+	TestResults.push_back(testValue(string("first second"), SourceVector[0] + " " + CopiedVector[1]));
+
+	cout << "Testing move constructor: ";
+	TVector<string> MovedVector(std::move(CopiedVector));
+	TestResults.push_back(testValue(string("changed"), MovedVector.front()));
+
+	cout << "Testing swap function: ";
+	swap(SourceVector, MovedVector);
+	TestResults.push_back(testValue(string("changed"), SourceVector.front()));
+
+	// Check relocation of non trivially relocatable elements
+	cout << "Testing emplace/erase with std::string: ";
+	TVector<string> StringVector;
+	for (auto Index = 0; Index < 20; ++Index)
+		StringVector.pushBack(Index % 2 ? to_string(Index) : string(32, 'a' + Index));
+	auto StringIterator = StringVector.emplace(StringVector.begin() + 3, "short");
+	StringVector.erase(StringVector.begin() + 1);
+	StringVector.popBack();
+	TestResults.push_back(testValue(string("short ") + string(32, 'a' + 2) + " " + string(32, 'a' + 18), *StringIterator + " " + StringVector[1] + " " + StringVector.back()));
+
+	// Check bulk append functions
+	cout << "Testing emplaceBackN function: ";
+	TVector<int> BulkVector;
+	BulkVector.pushBack(-1);
+	auto BulkIterator = BulkVector.emplaceBackN(1000, [](unsigned int Index) { return static_cast<int>(Index); });
+	TestResults.push_back(testValue(999, *(BulkIterator + 999)));
+
+	cout << "Testing append function: ";
+	vector<int> BulkSource{ 7, 8, 9 };
+	BulkIterator = BulkVector.append(BulkSource.begin(), BulkSource.end());
+	TestResults.push_back(testValue(8, *(++BulkIterator)));
+
+	cout << "Testing resize function: ";
+	BulkVector.resize(10);
+	BulkVector.resize(12, 5);
+	TestResults.push_back(testValue(string("8 5 12"), to_string(BulkVector[9]) + " " + to_string(BulkVector.back()) + " " + to_string(BulkVector.size())));
+
+	cout << "Testing assign function: ";
+	BulkVector.assign({ 1, 2, 3 });
+	TestResults.push_back(testValue(3, *(BulkVector.end() - 1)));
+
+	// Check random access iterator functions
+	cout << "Testing Iterator distance and comparison functions: ";
+	TVector<int> SortedVector;
+	SortedVector.emplaceBackN(100, [](unsigned int Index) { return static_cast<int>(Index * 2); });
+	auto SortedIterator = lower_bound(SortedVector.begin(), SortedVector.end(), 51);
+	bool IteratorCorrect = SortedIterator - SortedVector.begin() == 26 && distance(SortedVector.begin(), SortedVector.end()) == 100;
+	IteratorCorrect = IteratorCorrect && !(SortedIterator > SortedIterator) && SortedIterator >= SortedIterator && SortedIterator[2] == 56;
+	TestResults.push_back(testValue(true, IteratorCorrect));
+
+	// Check sorted vector
+	cout << "Testing SortedTVector insert/find functions: ";
+	SortedTVector<int> OrderedVector;
+	for (auto Value : { 50, 10, 40, 20, 30 })
+		OrderedVector.insert(Value);
+	auto OrderedIterator = OrderedVector.find(40);
+	vector<int> OrderedBatch{ 5, 25, 40, 60 };
+	OrderedVector.insertSorted(OrderedBatch.begin(), OrderedBatch.end());
+	OrderedVector.enableSearchIndex(true);
+	auto OrderedRange = OrderedVector.equalRange(40);
+	bool OrderedCorrect = is_sorted(OrderedVector.begin(), OrderedVector.end()) && *OrderedIterator == 40 && OrderedRange.second - OrderedRange.first == 2;
+	OrderedCorrect = OrderedCorrect && OrderedRange.first == OrderedIterator && OrderedVector.find(35) == OrderedVector.end() && *OrderedVector.lowerBound(26) == 30;
+	const auto& ConstOrderedVector = OrderedVector;
+	OrderedCorrect = OrderedCorrect && *ConstOrderedVector.upperBound(40) == 50 && ConstOrderedVector.find(40) == OrderedIterator;
+	TestResults.push_back(testValue(true, OrderedCorrect));
+
+	// Check mutation log
+	cout << "Testing MutationLog replay: ";
+	MutationLog Log(1 << 16);
+	TVector<int> PrimaryVector, FollowerVector;
+	MutationReplayer<int> Replayer(Log, FollowerVector);
+	PrimaryVector.pushBack(1);
+	PrimaryVector.setObserver(&Log);
+	PrimaryVector.emplaceBackN(10, [](unsigned int Index) { return static_cast<int>(Index); });
+	PrimaryVector.emplace(PrimaryVector.begin() + 3, 42);
+	PrimaryVector.erase(PrimaryVector.begin() + 5);
+	PrimaryVector.popBack();
+	Replayer.apply();
+	bool ReplayCorrect = equal(PrimaryVector.begin(), PrimaryVector.end(), FollowerVector.begin(), FollowerVector.end());
+	TestResults.push_back(testValue(true, ReplayCorrect));
+
+	// Check mutation log with in-place writes and layout changes
+	cout << "Testing MutationLog in-place writes and optimizeLayout: ";
+	PrimaryVector[2] = 7;
+	*(PrimaryVector.begin() + 4) = 9;
+	PrimaryVector.back() = 11;
+	PrimaryVector.erase(PrimaryVector.begin());
+	PrimaryVector.front() = 5;
+	PrimaryVector.data()[3] = 13;
+	PrimaryVector.publishWrites();
+	PrimaryVector.optimizeLayout(4);
+	PrimaryVector.at(1) = 17;
+	PrimaryVector.publishWrites();
+	Replayer.apply();
+	MutationLog LateLog(1 << 16);
+	TVector<int> LateVector;
+	MutationReplayer<int> LateReplayer(LateLog, LateVector);
+	PrimaryVector.setObserver(&LateLog);
+	LateReplayer.apply();
+	ReplayCorrect = equal(PrimaryVector.begin(), PrimaryVector.end(), FollowerVector.begin(), FollowerVector.end()) && equal(PrimaryVector.begin(), PrimaryVector.end(), LateVector.begin(), LateVector.end());
+	ReplayCorrect = ReplayCorrect && PrimaryVector[0] == 5 && PrimaryVector[1] == 17 && PrimaryVector[3] == 13;
+	ReplayCorrect = ReplayCorrect && FollowerVector.memoryUsage().mMarkBytes == PrimaryVector.memoryUsage().mMarkBytes && LateVector.memoryUsage().mMarkBytes == PrimaryVector.memoryUsage().mMarkBytes;
+	TestResults.push_back(testValue(true, ReplayCorrect));
+
+	// Check snapshots
+	cout << "Testing snapshot function: ";
+	TVector<int> LiveVector;
+	LiveVector.emplaceBackN(50000, [](unsigned int Index) { return static_cast<int>(Index); });
+	auto SnapshotHandle = LiveVector.begin() + 40000;
+	auto FrozenVector = LiveVector.snapshot();
+	LiveVector.erase(LiveVector.begin() + 10);
+	LiveVector.emplace(LiveVector.begin(), -1);
+	LiveVector[40000] = -2;
+	LiveVector.emplaceBackN(50000, [](unsigned int) { return 0; });
+	int SnapshotElement = 0;
+	bool SnapshotCorrect = FrozenVector.size() == 50000 && FrozenVector[10] == 10 && FrozenVector[40000] == 40000 && FrozenVector.find(SnapshotHandle, SnapshotElement) && SnapshotElement == 40000;
+	TestResults.push_back(testValue(true, SnapshotCorrect && *SnapshotHandle == -2 && LiveVector.size() == 100000));
+
+	// Check multi column vector
+	cout << "Testing TVectorSoA emplace/erase functions: ";
+	TVectorSoA<float, int, string> ColumnVector;
+	for (auto Index = 0; Index < 10; ++Index)
+		ColumnVector.emplaceBack(Index * 0.5f, Index, to_string(Index));
+	auto ColumnIterator = ColumnVector.begin();
+	for (auto Index = 0; Index < 7; ++Index)
+		++ColumnIterator;
+	ColumnVector.erase(ColumnVector.begin());
+	ColumnVector.emplace(ColumnVector.begin(), 9.5f, -1, string("new"));
+	ColumnVector.erase(ColumnVector.begin());
+	bool ColumnCorrect = ColumnIterator.get<1>() == 7 && ColumnIterator.get<2>() == "7" && ColumnVector.column<0>()[ColumnIterator.index()] == 3.5f;
+	ColumnCorrect = ColumnCorrect && ColumnIterator - ColumnVector.begin() == 6 && (ColumnVector.begin() + 6) == ColumnIterator && (ColumnIterator - 2).get<1>() == 5 && ColumnVector.begin() < ColumnIterator && ColumnVector.end() >= ColumnIterator;
+	auto ColumnCopy = ColumnVector;
+	ColumnCopy.get<2>(0) = "copy";
+	auto ColumnMoved = std::move(ColumnCopy);
+	ColumnCorrect = ColumnCorrect && ColumnMoved.size() == 9 && ColumnMoved.get<2>(0) == "copy" && ColumnVector.get<2>(0) == "1" && ColumnCopy.empty() && ColumnCopy.begin() == ColumnCopy.end();
+	TestResults.push_back(testValue(true, ColumnCorrect && ColumnIterator.index() == 6 && ColumnVector.size() == 9));
+
+	// Check streaming append
+	cout << "Testing appendFrom function: ";
+	vector<int> StreamSource(10000);
+	for (auto Index = 0u; Index < StreamSource.size(); ++Index)
+		StreamSource[Index] = static_cast<int>(Index);
+	size_t StreamOffset = 0u;
+	AsyncByteReader StreamReader([&StreamSource, &StreamOffset](void* Buffer, size_t Bytes)
+	{
+		auto Count = min(Bytes, StreamSource.size() * sizeof(int) - StreamOffset);
+		memcpy(Buffer, reinterpret_cast<const char*>(StreamSource.data()) + StreamOffset, Count);
+		StreamOffset += Count;
+		return Count;
+	}, 4096);
+	TVector<int> StreamVector;
+	StreamVector.pushBack(-1);
+	auto StreamCount = StreamVector.appendFrom(StreamReader.elements<int>(), 1000);
+	TestResults.push_back(testValue(true, StreamCount == 10000 && StreamVector.size() == 10001 && StreamVector[1] == 0 && StreamVector.back() == 9999 && *(StreamVector.end() - 2) == 9998));
+
+	// Check mark table compaction
+	cout << "Testing optimizeLayout function: ";
+	TVector<int> LayoutVector;
+	LayoutVector.emplaceBackN(100, [](unsigned int Index) { return static_cast<int>(Index); });
+	for (auto Index = 0; Index < 10; ++Index)
+		LayoutVector.erase(LayoutVector.begin() + Index * 5);
+	auto LayoutHandle = LayoutVector.begin() + 50;
+	auto ErasedHandle = LayoutVector.begin() + 60;
+	LayoutVector.erase(ErasedHandle);
+	auto LayoutRemap = LayoutVector.optimizeLayout(1);
+	bool LayoutCorrect = LayoutHandle.isValid() && *LayoutHandle == 60 && !ErasedHandle.isValid();
+	auto RemappedHandle = LayoutRemap(LayoutHandle);
+	LayoutVector.popBack();
+	LayoutVector.popBack();
+	LayoutCorrect = LayoutCorrect && !LayoutHandle.isValid() && RemappedHandle.isValid() && *RemappedHandle == 60 && !LayoutRemap(ErasedHandle).isValid();
+	TestResults.push_back(testValue(true, LayoutCorrect && RemappedHandle - LayoutVector.begin() == 50));
+
+	// Check static capacity vector
+	cout << "Testing StaticTVector functions: ";
+	constexpr auto StaticTable = makeStaticTable();
+	StaticTVector<string, 4> StaticVector;
+	auto StaticHandle = StaticVector.pushBack("b");
+	StaticVector.emplace(StaticVector.begin(), "a");
+	auto StaticErased = StaticVector.pushBack("c");
+	StaticVector.erase(StaticErased);
+	StaticVector.pushBack("d");
+	bool StaticCorrect = StaticTable.size() == 5 && StaticTable[0] == 5 && StaticTable[2] == 30 && *(StaticTable.end() - 1) == 50;
+	StaticCorrect = StaticCorrect && *StaticHandle == "b" && StaticHandle - StaticVector.begin() == 1 && !StaticErased.isValid() && StaticVector.back() == "d";
+	const auto& ConstStaticVector = StaticVector;
+	StaticCorrect = StaticCorrect && is_same<decltype(*ConstStaticVector.begin()), const string&>::value && ConstStaticVector.begin() + 1 == StaticHandle && *(ConstStaticVector.end() - 1) == "d";
+	TestResults.push_back(testValue(true, StaticCorrect));
+
+	cout << "Testing 16 and 64 bit positions: ";
+	TVector<int, std::uint16_t, std::uint16_t> NarrowVector;
+	TVector<int, std::uint64_t, std::uint64_t> WideVector;
+	vector<int> WidthModel;
+	for (auto Index = 0; Index < 3000; ++Index)
+	{
+		NarrowVector.emplaceBack(Index);
+		WideVector.emplaceBack(Index);
+		WidthModel.push_back(Index);
+	}
+	auto NarrowHandle = NarrowVector.begin() + 2000;
+	auto WideHandle = WideVector.begin() + 2000;
+	NarrowVector.erase(NarrowVector.begin() + 10, NarrowVector.begin() + 1010);
+	WideVector.erase(WideVector.begin() + 10, WideVector.begin() + 1010);
+	WidthModel.erase(WidthModel.begin() + 10, WidthModel.begin() + 1010);
+	bool WidthCorrect = equal(NarrowVector.begin(), NarrowVector.end(), WidthModel.begin(), WidthModel.end()) && equal(WideVector.begin(), WideVector.end(), WidthModel.begin(), WidthModel.end());
+	WidthCorrect = WidthCorrect && *NarrowHandle == 2000 && *WideHandle == 2000 && NarrowVector.max_size() == 65534u;
+	TestResults.push_back(testValue(true, WidthCorrect));
+
+	cout << "Testing parallel relocation: ";
+	TVector<array<int, 128>> RecordVector;
+	vector<array<int, 128>> RecordModel;
+	RecordVector.setParallelRelocation(1u, TVectorExecutor(), 1u);
+	for (auto Index = 0; Index < 2000; ++Index)
+	{
+		array<int, 128> Record;
+		Record.fill(Index);
+		RecordVector.emplaceBack(Record);
+		RecordModel.push_back(Record);
+	}
+	auto RecordHandle = RecordVector.begin() + 1500;
+	for (auto Index = 0; Index < 5; ++Index)
+	{
+		RecordVector.emplace(RecordVector.begin() + Index * 3, RecordModel.back());
+		RecordModel.insert(RecordModel.begin() + Index * 3, RecordModel.back());
+	}
+	RecordVector.erase(RecordVector.begin() + 7, RecordVector.begin() + 200);
+	RecordModel.erase(RecordModel.begin() + 7, RecordModel.begin() + 200);
+	bool RecordCorrect = equal(RecordVector.begin(), RecordVector.end(), RecordModel.begin(), RecordModel.end()) && (*RecordHandle)[127] == 1500;
+	TestResults.push_back(testValue(true, RecordCorrect));
+
+	cout << "Testing MutationBatch commit: ";
+	TVector<int> BatchVector;
+	for (auto Index = 0; Index < 10; ++Index)
+		BatchVector.pushBack(Index);
+	auto BatchKept = BatchVector.begin() + 5;
+	auto BatchErased = BatchVector.begin() + 3;
+	auto Batch = BatchVector.beginBatch();
+	auto BatchFront = Batch.emplace(BatchVector.begin(), -1);
+	Batch.erase(BatchErased);
+	auto BatchMiddle = Batch.emplace(BatchVector.begin() + 5, 50);
+	Batch.erase(BatchVector.begin() + 9);
+	auto BatchBack = Batch.emplace(BatchVector.end(), 100);
+	Batch.commit();
+	vector<int> BatchExpected { -1, 0, 1, 2, 4, 50, 5, 6, 7, 8, 100 };
+	bool BatchCorrect = equal(BatchVector.begin(), BatchVector.end(), BatchExpected.begin(), BatchExpected.end());
+	BatchCorrect = BatchCorrect && *BatchFront == -1 && *BatchMiddle == 50 && *BatchBack == 100 && *BatchKept == 5 && !BatchErased.isValid();
+	TestResults.push_back(testValue(true, BatchCorrect));
+
+	cout << "Testing eraseIf/retainIf functions: ";
+	TVector<int> FilterVector;
+	for (auto Index = 0; Index < 20; ++Index)
+		FilterVector.pushBack(Index);
+	auto FilterKept = FilterVector.begin() + 7;
+	auto FilterErased = FilterVector.begin() + 6;
+	auto FilterRemoved = FilterVector.eraseIf([](int Value) { return Value % 3 == 0; });
+	FilterRemoved += FilterVector.retainIf([](int Value) { return Value < 15; });
+	vector<int> FilterExpected { 1, 2, 4, 5, 7, 8, 10, 11, 13, 14 };
+	bool FilterCorrect = FilterRemoved == 10u && equal(FilterVector.begin(), FilterVector.end(), FilterExpected.begin(), FilterExpected.end());
+	FilterCorrect = FilterCorrect && *FilterKept == 7 && FilterKept - FilterVector.begin() == 4 && !FilterErased.isValid();
+	TestResults.push_back(testValue(true, FilterCorrect));
+
+	cout << "Testing TVectorIndexed find function: ";
+	struct IndexedKey
+	{
+		int operator()(const pair<int, string>& Element) const
+		{
+			return Element.first;
+		}
+	};
+	TVectorIndexed<pair<int, string>, IndexedKey> IndexedVector;
+	for (auto Index = 0; Index < 1000; ++Index)
+		IndexedVector.emplace(IndexedVector.begin() + Index / 2, Index * 7, to_string(Index));
+	for (auto Index = 0; Index < 1000; Index += 3)
+		IndexedVector.eraseKey(Index * 7);
+	IndexedVector.erase(IndexedVector.find(7 * 7));
+	bool IndexedCorrect = IndexedVector.size() == 665u && IndexedVector.find(3 * 7) == IndexedVector.end() && IndexedVector.find(7 * 7) == IndexedVector.end();
+	IndexedCorrect = IndexedCorrect && IndexedVector.find(500 * 7)->second == "500" && IndexedVector.find(998 * 7)->second == "998" && !IndexedVector.contains(5);
+	TestResults.push_back(testValue(true, IndexedCorrect));
+
+	cout << "Testing ConcurrentTVector appends: ";
+	ConcurrentTVector<string> ConcurrentVector;
+	vector<ConcurrentTVector<string>::Iterator> ConcurrentFirsts(4);
+	vector<thread> ConcurrentThreads;
+	for (auto ThreadIndex = 0; ThreadIndex < 4; ++ThreadIndex)
+		ConcurrentThreads.emplace_back([&, ThreadIndex]()
+		{
+			auto Producer = ConcurrentVector.producer(100u);
+			ConcurrentFirsts[ThreadIndex] = ConcurrentVector.emplaceBack(to_string(ThreadIndex));
+			for (auto Index = 0; Index < 5000; ++Index)
+				(ThreadIndex % 2 ? Producer.emplaceBack(to_string(Index)) : ConcurrentVector.pushBack(to_string(Index)));
+		});
+	for (auto& Thread : ConcurrentThreads)
+		Thread.join();
+	size_t ConcurrentCount = 0u, ConcurrentSum = 0u;
+	ConcurrentVector.forEach([&](const string& Value) { ++ConcurrentCount; ConcurrentSum += stoul(Value); });
+	bool ConcurrentCorrect = ConcurrentVector.publishedSize() == ConcurrentVector.size() && ConcurrentCount == 20004u && ConcurrentSum == 4u * 4999u * 2500u + 6u;
+	for (auto ThreadIndex = 0; ThreadIndex < 4; ++ThreadIndex)
+		ConcurrentCorrect = ConcurrentCorrect && ConcurrentFirsts[ThreadIndex].isValid() && *ConcurrentFirsts[ThreadIndex] == to_string(ThreadIndex);
+	TestResults.push_back(testValue(true, ConcurrentCorrect));
+
+	cout << "Testing GapTVector front and cursor edits: ";
+	GapTVector<int> GapVector;
+	deque<int> GapExpected;
+	for (auto Index = 0; Index < 100; ++Index)
+	{
+		GapVector.pushFront(Index);
+		GapVector.pushBack(-Index);
+		GapExpected.push_front(Index);
+		GapExpected.push_back(-Index);
+	}
+	auto GapFirst = GapVector.begin();
+	auto GapCursor = GapVector.begin() + 50;
+	for (auto Index = 0; Index < 100; ++Index)
+	{
+		GapExpected.insert(GapExpected.begin() + 50 + Index, 1000 + Index);
+		GapCursor = GapVector.emplace(GapCursor, 1000 + Index) + 1;
+	}
+	GapVector.popFront();
+	GapExpected.pop_front();
+	GapVector.erase(GapVector.begin() + 20);
+	GapExpected.erase(GapExpected.begin() + 20);
+	bool GapCorrect = equal(GapVector.begin(), GapVector.end(), GapExpected.begin(), GapExpected.end()) && !GapFirst.isValid() && *GapCursor == 49 && GapVector[150] == GapExpected[150];
+	const auto& ConstGapVector = GapVector;
+	GapCorrect = GapCorrect && is_same<decltype(*ConstGapVector.begin()), const int&>::value && ConstGapVector.end() - GapCursor == static_cast<ptrdiff_t>(GapVector.size()) - (GapCursor - GapVector.begin());
+	auto MovedGapVector = std::move(GapVector);
+	GapCorrect = GapCorrect && GapVector.empty() && GapVector.begin() == GapVector.end() && MovedGapVector.size() == GapExpected.size();
+	TestResults.push_back(testValue(true, GapCorrect));
+
+	cout << "Testing dirty range tracking: ";
+	TVector<int> DirtyVector;
+	for (auto Index = 0; Index < 5000; ++Index)
+		DirtyVector.pushBack(Index);
+	DirtyVector.setDirtyTracking(true);
+	auto DirtyAll = DirtyVector.consumeDirty();
+	DirtyVector[10] = -1;
+	*(DirtyVector.begin() + 3000) = -2;
+	DirtyVector.erase(DirtyVector.begin() + 4500);
+	auto DirtySome = DirtyVector.consumeDirty();
+	vector<pair<unsigned int, unsigned int>> DirtyExpected { { 0u, 1024u }, { 2048u, 3072u }, { 4096u, 4999u } };
+	bool DirtyCorrect = DirtyAll.size() == 1u && DirtyAll[0].second == 5000u && DirtySome == DirtyExpected && DirtyVector.consumeDirty().empty();
+	TestResults.push_back(testValue(true, DirtyCorrect));
+
+	cout << "Testing shrink policy and memoryUsage: ";
+	TVector<int> ShrinkVector;
+	ShrinkVector.setShrinkPolicy(4u);
+	for (auto Index = 0; Index < 4096; ++Index)
+		ShrinkVector.pushBack(Index);
+	auto ShrinkKept = ShrinkVector.begin() + 10;
+	auto ShrinkPeak = ShrinkVector.memoryUsage();
+	while (ShrinkVector.size() > 100u)
+		ShrinkVector.popBack();
+	auto ShrinkLow = ShrinkVector.memoryUsage();
+	bool ShrinkCorrect = *ShrinkKept == 10 && ShrinkVector.capacity() <= 400u;
+	ShrinkVector.clear();
+	auto ShrinkCleared = ShrinkVector.memoryUsage();
+	ShrinkCorrect = ShrinkCorrect && ShrinkPeak.mPayloadBytes == 4096u * sizeof(int) && ShrinkLow.mPayloadBytes == 100u * sizeof(int);
+	ShrinkCorrect = ShrinkCorrect && ShrinkVector.capacity() == 1u && ShrinkLow.mAtomBytes * 10u < ShrinkPeak.mAtomBytes && ShrinkLow.mMarkBytes == ShrinkPeak.mMarkBytes;
+	ShrinkCorrect = ShrinkCorrect && ShrinkCleared.total() < 64u && !ShrinkKept.isValid();
+	TestResults.push_back(testValue(true, ShrinkCorrect));
+
+	cout << "Testing ShardedTVector handles and parallel reduce: ";
+	ShardedTVector<int, 8> ShardedVector;
+	vector<vector<ShardedTVector<int, 8>::Handle>> ShardedHandles(4);
+	vector<thread> ShardedThreads;
+	for (auto ThreadIndex = 0; ThreadIndex < 4; ++ThreadIndex)
+		ShardedThreads.emplace_back([&, ThreadIndex]()
+		{
+			for (auto Index = 1; Index <= 3000; ++Index)
+				ShardedHandles[ThreadIndex].push_back(ShardedVector.pushBack(Index));
+			for (auto Index = 0; Index < 3000; Index += 2)
+				ShardedVector.erase(ShardedHandles[ThreadIndex][Index]);
+		});
+	for (auto& Thread : ShardedThreads)
+		Thread.join();
+	ShardedVector.forEach([](int& Value) { Value *= 2; });
+	auto ShardedSum = ShardedVector.reduce(0ll, [](long long Left, long long Right) { return Left + Right; }, [](const int& Value) { return static_cast<long long>(Value); });
+	int ShardedValue = 0;
+	bool ShardedCorrect = ShardedVector.size() == 6000u && ShardedSum == 4ll * 2 * 1500 * 1500 + 4ll * 2 * 1500;
+	ShardedCorrect = ShardedCorrect && ShardedVector.visit(ShardedHandles[2][9], [&](int& Value) { ShardedValue = Value; }) && ShardedValue == 20 && !ShardedVector.isValid(ShardedHandles[3][8]);
+	TestResults.push_back(testValue(true, ShardedCorrect));
+
+	cout << "Testing optimizeLayout past the 16 bit ID range: ";
+	TVector<int, std::uint16_t, std::uint16_t> RebaseVector;
+	RebaseVector.emplaceBackN(4, [](std::uint16_t Index) { return static_cast<int>(Index); });
+	auto RebaseHandle = RebaseVector.begin() + 2;
+	bool RebaseCorrect = true, RebaseSeen = false;
+	for (auto Pass = 0; Pass < 70000 && RebaseCorrect; ++Pass)
+	{
+		auto RebaseRemap = RebaseVector.optimizeLayout(Pass % 2);
+		RebaseSeen = RebaseSeen || RebaseRemap.rebased();
+		RebaseCorrect = RebaseHandle.isValid() == (Pass % 2 && !RebaseRemap.rebased());
+		RebaseHandle = RebaseRemap(RebaseHandle);
+		RebaseCorrect = RebaseCorrect && RebaseHandle.isValid() && *RebaseHandle == 2 && (RebaseVector.begin() + 1).isValid();
+		if (Pass % 5000 == 0)
+			RebaseVector.erase(RebaseVector.emplace(RebaseVector.begin(), -1));
+	}
+	TestResults.push_back(testValue(true, RebaseCorrect && RebaseSeen));
+
+	cout << "Testing emplace with a throwing constructor: ";
+	TVector<ThrowingValue> ThrowingVector;
+	for (auto Index = 0; Index < 5; ++Index)
+		ThrowingVector.emplaceBack(Index);
+	auto ThrowingHandle = ThrowingVector.begin() + 4;
+	bool ThrowingCaught = false;
+	try
+	{
+		ThrowingVector.emplace(ThrowingVector.begin() + 1, -1);
+	}
+	catch (const runtime_error&)
+	{
+		ThrowingCaught = true;
+	}
+	bool ThrowingCorrect = ThrowingCaught && ThrowingVector.size() == 5u && ThrowingHandle->mName == "4";
+	for (auto Index = 0; Index < 5; ++Index)
+		ThrowingCorrect = ThrowingCorrect && ThrowingVector[Index].mName == to_string(Index);
+	ThrowingVector.emplace(ThrowingVector.begin() + 1, 9);
+	ThrowingCorrect = ThrowingCorrect && ThrowingVector.size() == 6u && ThrowingVector[1].mName == "9" && ThrowingVector.back().mName == "4";
+	TestResults.push_back(testValue(true, ThrowingCorrect));
+
+	cout << "Testing reuse of a moved vector: ";
+	TVector<string> MovedFromVector;
+	MovedFromVector.pushBack("kept");
+	auto MovedFromHandle = MovedFromVector.begin();
+	TVector<string> MovedToVector(std::move(MovedFromVector));
+	bool MovedFromCorrect = MovedFromVector.empty() && MovedFromVector.begin() == MovedFromVector.end() && !MovedFromHandle.isValid();
+	MovedFromVector.pushBack("a");
+	MovedFromVector.emplace(MovedFromVector.begin(), "b");
+	MovedToVector = std::move(MovedFromVector);
+	MovedFromVector.pushBack("c");
+	MovedFromCorrect = MovedFromCorrect && MovedToVector.size() == 2u && MovedToVector[0] == "b" && MovedFromVector.size() == 1u && MovedFromVector.front() == "c";
+	TestResults.push_back(testValue(true, MovedFromCorrect));
+
+	cout << "Testing const iterators: ";
+	TVector<int> ConstVector;
+	ConstVector.emplaceBackN(10, [](unsigned int Index) { return static_cast<int>(Index); });
+	const auto& ConstView = ConstVector;
+	TVector<int>::CIterator ConstHandle = ConstVector.begin() + 3;
+	auto ConstSum = 0;
+	for (auto Element = ConstView.begin(); Element != ConstView.end(); ++Element)
+		ConstSum += *Element;
+	bool ConstCorrect = is_same<decltype(*ConstVector.cbegin()), const int&>::value && is_same<decltype(ConstView.begin()[1]), const int&>::value;
+	ConstCorrect = ConstCorrect && ConstSum == 45 && *ConstHandle == 3 && ConstHandle == ConstVector.begin() + 3 && ConstVector.end() - ConstHandle == 7;
+	ConstVector.erase(ConstHandle);
+	ConstCorrect = ConstCorrect && !ConstHandle.isValid() && ConstVector.size() == 9u;
+	TestResults.push_back(testValue(true, ConstCorrect));
+
+	cout << "Testing read-only loops with dirty tracking: ";
+	TVector<int> ReadOnlyVector;
+	ReadOnlyVector.emplaceBackN(5000, [](unsigned int Index) { return static_cast<int>(Index); });
+	ReadOnlyVector.setDirtyTracking(true);
+	ReadOnlyVector.consumeDirty();
+	const auto& ReadOnlyView = ReadOnlyVector;
+	long long ReadOnlySum = ReadOnlyView.front() + ReadOnlyView.back() + ReadOnlyView.at(7);
+	for (auto Element = ReadOnlyVector.cbegin(); Element != ReadOnlyVector.cend(); ++Element)
+		ReadOnlySum += *Element;
+	for (auto Index = 0u; Index < ReadOnlyView.size(); ++Index)
+		ReadOnlySum += ReadOnlyView[Index];
+	for (auto& Element : ReadOnlyView)
+		ReadOnlySum += Element;
+	bool ReadOnlyCorrect = ReadOnlySum == 3ll * 4999 * 5000 / 2 + 4999 + 7 && ReadOnlyVector.consumeDirty().empty();
+	*(ReadOnlyVector.begin() + 10) = -1;
+	ReadOnlyCorrect = ReadOnlyCorrect && ReadOnlyVector.consumeDirty().size() == 1u;
+	TestResults.push_back(testValue(true, ReadOnlyCorrect));
+
+	cout << "Testing mergeSorted with a throwing constructor: ";
+	TVector<ThrowingValue> MergedVector;
+	for (auto Index = 0; Index < 10; Index += 2)
+		MergedVector.emplaceBack(Index);
+	vector<int> MergedBatch { 1, 5, 9 };
+	auto ByName = [](const ThrowingValue& Left, const ThrowingValue& Right) { return Left.mName < Right.mName; };
+	bool MergedCorrect = MergedVector.mergeSorted(MergedBatch.begin(), MergedBatch.end(), ByName) == 3u && MergedVector.size() == 8u;
+	vector<string> MergedExpected { "0", "1", "2", "4", "5", "6", "8", "9" };
+	for (auto Index = 0u; Index < MergedExpected.size(); ++Index)
+		MergedCorrect = MergedCorrect && MergedVector[Index].mName == MergedExpected[Index];
+	TestResults.push_back(testValue(true, MergedCorrect));
+
+	cout << "Testing MutationLog overflow: ";
+	MutationLog SmallLog(1024);
+	SmallLog.setWriteTimeout(chrono::milliseconds(1));
+	TVector<int> StalledVector;
+	StalledVector.setObserver(&SmallLog);
+	bool OverflowCorrect = !SmallLog.overflowed();
+	for (auto Index = 0; Index < 100; ++Index)
+		StalledVector.pushBack(Index);
+	OverflowCorrect = OverflowCorrect && SmallLog.overflowed() && StalledVector.size() == 100u && SmallLog.pendingBytes() <= 1024u;
+	TestResults.push_back(testValue(true, OverflowCorrect));
+
+	cout << "Testing TVectorSoA with 16 bit positions and const iterators: ";
+	BasicTVectorSoA<std::uint16_t, std::uint16_t, int, ThrowingValue> NarrowColumns;
+	for (auto Index = 0; Index < 5; ++Index)
+		NarrowColumns.emplaceBack(Index, Index);
+	auto NarrowKept = NarrowColumns.begin();
+	for (auto Index = 0; Index < 2; ++Index)
+		++NarrowKept;
+	bool NarrowThrown = false;
+	try
+	{
+		NarrowColumns.emplace(NarrowColumns.begin(), 10, -1);
+	}
+	catch (const runtime_error&)
+	{
+		NarrowThrown = true;
+	}
+	NarrowKept.get<0>() *= 10;
+	const auto& NarrowView = NarrowColumns;
+	auto NarrowSum = 0;
+	for (auto Element = NarrowView.begin(); Element != NarrowView.end(); ++Element)
+		NarrowSum += Element.get<0>();
+	bool NarrowCorrect = NarrowThrown && NarrowColumns.size() == 5u && NarrowSum == 28 && NarrowKept.index() == 2 && NarrowKept.get<1>().mName == "2";
+	NarrowCorrect = NarrowCorrect && is_same<decltype(NarrowView.cbegin().get<1>()), const ThrowingValue&>::value && NarrowView.column<1>()[4].mName == "4";
+	TestResults.push_back(testValue(true, NarrowCorrect));
+
+	cout << "Testing ShardedTVector reduce over a big shard: ";
+	ShardedTVector<int, 2> HotShardVector;
+	HotShardVector.withShard(1u, [](TVector<int>& Owner) { Owner.emplaceBackN(20000, [](unsigned int Index) { return static_cast<int>(Index); }); });
+	auto HotSum = HotShardVector.reduce(0ll, [](long long Left, long long Right) { return Left + Right; }, [](const int& Value) { return static_cast<long long>(Value); });
+	HotShardVector.forEach([](int& Value) { Value = 1; });
+	auto HotCount = HotShardVector.reduce(0, [](int Left, int Right) { return Left + Right; }, [](const int& Value) { return Value; });
+	TestResults.push_back(testValue(true, HotSum == 19999ll * 20000 / 2 && HotCount == 20000));
+
+	cout << "Testing mergeSorted with throwing copies: ";
+	TVector<FragileValue> FragileVector;
+	FragileValue::CopiesLeft = 1000;
+	for (auto Index = 0; Index < 10; Index += 2)
+		FragileVector.emplaceBack(Index);
+	auto FragileHandle = FragileVector.begin() + 3;
+	vector<FragileValue> FragileBatch { 1, 5, 9 };
+	bool FragileThrown = false;
+	FragileValue::CopiesLeft = 6;
+	try
+	{
+		FragileVector.mergeSorted(FragileBatch.begin(), FragileBatch.end(), less<FragileValue>());
+	}
+	catch (const runtime_error&)
+	{
+		FragileThrown = true;
+	}
+	bool FragileCorrect = FragileThrown && FragileVector.size() == 5u && FragileHandle->mValue == 6;
+	for (auto Index = 0; Index < 5; ++Index)
+		FragileCorrect = FragileCorrect && FragileVector[Index].mValue == Index * 2;
+	FragileValue::CopiesLeft = 1000;
+	FragileCorrect = FragileCorrect && FragileVector.mergeSorted(FragileBatch.begin(), FragileBatch.end(), less<FragileValue>()) == 3u;
+	vector<int> FragileExpected { 0, 1, 2, 4, 5, 6, 8, 9 };
+	for (auto Index = 0u; Index < FragileExpected.size(); ++Index)
+		FragileCorrect = FragileCorrect && FragileVector[Index].mValue == FragileExpected[Index];
+	TestResults.push_back(testValue(true, FragileCorrect && FragileHandle->mValue == 6 && FragileHandle - FragileVector.begin() == 5 && (FragileVector.end() - 1)->mValue == 9));
+
 	// Count the passed test
 	auto PassedTests = count(TestResults.begin(), TestResults.end(), true);
 